@@ -0,0 +1,119 @@
+#include "ActorTable.h"
+
+// Adds the actor to the end of its type's list and returns its new id.
+// Freed slots are reused, with the generation they were left at.
+ActorId ActorTable::Add(shared_ptr<IActor> actor)
+{
+	int type = actor->VGet()->m_Type;
+	if (type < 0 || type >= AT_COUNT)
+		type = AT_UNKNOWN;
+
+	// Slot 0 stays empty so no actor gets INVALID_ACTOR_ID.
+	if (m_slots.empty())
+		m_slots.push_back(ActorSlot());
+
+	ActorId index;
+	if (m_freeSlots.empty())
+	{
+		index = m_slots.size();
+		m_slots.push_back(ActorSlot());
+	}
+	else
+	{
+		index = m_freeSlots.back();
+		m_freeSlots.pop_back();
+	}
+
+	ActorSlot &slot = m_slots[index];
+	ActorId id = MakeActorId(index, slot.m_generation);
+	slot.m_type = type;
+	slot.m_index = m_actors[type].size();
+	m_actors[type].push_back(actor);
+	m_ids[type].push_back(id);
+	return id;
+}
+
+// Gets the slot the id is for, or NULL if the id is stale or was never handed out.
+const ActorTable::ActorSlot *ActorTable::GetSlot(ActorId id) const
+{
+	ActorId index = GetActorIndex(id);
+	if (index >= m_slots.size())
+		return NULL;
+
+	const ActorSlot &slot = m_slots[index];
+	if (slot.m_index < 0 || slot.m_generation != GetActorGeneration(id))
+		return NULL;
+
+	return &slot;
+}
+
+// Takes the actor out of its list, moving the last one of the type into the
+// gap, and frees its slot. Returns false if there is no actor with the id.
+bool ActorTable::Remove(ActorId id)
+{
+	if (!GetSlot(id))
+		return false;
+
+	ActorSlot &slot = m_slots[GetActorIndex(id)];
+	int type = slot.m_type;
+	int index = slot.m_index;
+	ActorId moved = m_ids[type].back();
+
+	m_actors[type][index] = m_actors[type].back();
+	m_ids[type][index] = moved;
+	m_slots[GetActorIndex(moved)].m_index = index;
+	m_actors[type].pop_back();
+	m_ids[type].pop_back();
+
+	// A slot that has run out of generations is never used again, so no id can come back around.
+	slot.m_type = AT_UNKNOWN;
+	slot.m_index = -1;
+	if (slot.m_generation < ACTOR_GENERATION_MAX)
+	{
+		slot.m_generation++;
+		m_freeSlots.push_back(GetActorIndex(id));
+	}
+	return true;
+}
+
+// Removes every actor.
+void ActorTable::Clear()
+{
+	m_slots.clear();
+	m_freeSlots.clear();
+	for (int t = 0; t < AT_COUNT; t++)
+	{
+		m_actors[t].clear();
+		m_ids[t].clear();
+	}
+}
+
+// Gets the actor with the id, or an empty pointer if there isn't one.
+shared_ptr<IActor> ActorTable::Find(ActorId id) const
+{
+	const ActorSlot *slot = GetSlot(id);
+	if (!slot)
+		return shared_ptr<IActor>();
+
+	return m_actors[slot->m_type][slot->m_index];
+}
+
+// Gets the type of the actor with the id, AT_UNKNOWN if there isn't one.
+ActorType ActorTable::GetType(ActorId id) const
+{
+	const ActorSlot *slot = GetSlot(id);
+	if (!slot)
+		return AT_UNKNOWN;
+
+	return (ActorType)slot->m_type;
+}
+
+// Checks if there are no actors at all.
+bool ActorTable::Empty() const
+{
+	for (int t = 0; t < AT_COUNT; t++)
+		if (!m_actors[t].empty())
+			return false;
+
+	return true;
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include "StdHeader.h"
+
+// The game's actors, kept in a packed list for each actor type so a loop over
+// one type only touches that type. The table hands out the actors' ids: an
+// id's index is its slot here, which says where the actor is in its list, and
+// its generation has to match the slot's for the id to find anything.
+// Removing an actor bumps the slot's generation before the slot is reused.
+// Slot 0 is never used, so INVALID_ACTOR_ID never finds anything.
+class ActorTable
+{
+	// Where the actor in a slot is, m_index is -1 if the slot is free.
+	struct ActorSlot
+	{
+		int			m_type;
+		int			m_index;
+		ActorId		m_generation;
+		ActorSlot():m_type(AT_UNKNOWN),m_index(-1),m_generation(0) {}
+	};
+
+	std::vector<ActorSlot>					m_slots;
+	std::vector<ActorId>					m_freeSlots;
+	std::vector<shared_ptr<IActor> >		m_actors[AT_COUNT];
+	std::vector<ActorId>					m_ids[AT_COUNT];
+
+	const ActorSlot *GetSlot(ActorId id) const;
+
+public:
+	ActorId Add(shared_ptr<IActor> actor);
+	bool Remove(ActorId id);
+	void Clear();
+	shared_ptr<IActor> Find(ActorId id) const;
+	ActorType GetType(ActorId id) const;
+	bool Empty() const;
+
+	// The actors of one type, in no particular order.
+	int Count(ActorType type) const {return m_actors[type].size();}
+	const shared_ptr<IActor> &Get(ActorType type, int i) const {return m_actors[type][i];}
+};
@@ -377,7 +377,7 @@ LRESULT GameApp::OnDisplayChange(int colorDepth, int width, int height)
 // Creates a base game and a human view.
 TowerGame* GameApp::CreateGameAndView()
 {
-	TowerGame* game = SAFE_NEW TowerGame();
+	TowerGame* game = SAFE_NEW TowerGame(m_ResCache);
 	if (game)
 	{
 
@@ -387,558 +387,6 @@ TowerGame* GameApp::CreateGameAndView()
 	return game;
 }
 
-/////////////////////////////////////////////////////////////////////////////////////////////
-/////////////////////////////////////////////////////////////////////////////////////////////
-//////////////////////////////////TowerGame//////////////////////////////////////////////////
-/////////////////////////////////////////////////////////////////////////////////////////////
-/////////////////////////////////////////////////////////////////////////////////////////////
-
-// Listener for Game events.
-void ListenForGameEvents(EventListenerPtr listener)
-{
-	safeAddListener( listener, EventType(Evt_New_Actor::gkName) );
-	safeAddListener( listener, EventType(Evt_Remove_Actor::gkName) );
-	safeAddListener( listener, EventType(Evt_New_Runner::gkName) );
-	safeAddListener( listener, EventType(Evt_New_Tower::gkName) );
-	safeAddListener( listener, EventType(Evt_Move_Actor::gkName) );
-	safeAddListener( listener, EventType(Evt_Change_GameState::gkName) );
-	safeAddListener( listener, EventType(Evt_Set_Path::gkName) );
-	safeAddListener( listener, EventType(Evt_Find_Closest_Tar::gkName) );
-	safeAddListener( listener, EventType(Evt_Shoot_Tar::gkName) );
-	safeAddListener( listener, EventType(Evt_Sell_Tower::gkName) );
-	safeAddListener( listener, EventType(Evt_Spawn_Wave::gkName) );
-	safeAddListener( listener, EventType(Evt_Change_Tower_Type::gkName) );
-	safeAddListener( listener, EventType(Evt_New_Tower_Type::gkName) );
-	safeAddListener( listener, EventType(Evt_Damage_Actor::gkName) );
-	safeAddListener( listener, EventType(Evt_Apply_Buff::gkName) );
-	safeAddListener( listener, EventType(Evt_Create_Missile::gkName) );
-	safeAddListener( listener, EventType(Evt_Left_Click::gkName) );
-	safeAddListener( listener, EventType(Evt_Select_Tower::gkName) );
-	safeAddListener( listener, EventType(Evt_Upgrade_Selected_Tower::gkName) );
-	safeAddListener( listener, EventType(Evt_Sell_Selected_Tower::gkName) );
-}
-
-// Base constructor, adds listener.
-TowerGame::TowerGame():m_gameMap()
-{
-	m_data.m_timeLeftUntilWave = 0;
-	m_data.m_waveTimeLimit = 10000;
-	m_data.m_curWave = 1;
-	m_data.m_curMoney = 6;
-	m_data.m_curLife = 10;
-	m_LastActorId = 0;
-	m_status = Game_Initializing;
-	m_curTowerType = -1;
-	m_selectedTower = 0;
-
-	EventListenerPtr gameLogicListener (SAFE_NEW GameLogicListener( this) );
-	ListenForGameEvents(gameLogicListener);
-	m_eventListener = gameLogicListener;
-}
-
-// Clears out all actors and flushes process list.
-TowerGame::~TowerGame()
-{
-	while(!m_pActorMap.empty())
-	{
-		ActorMap::iterator it = m_pActorMap.begin();
-		ActorId id = (*it).first;
-		m_pActorMap.erase(it);
-	}
-
-	m_processManager.DeleteProcessList();
-}
-
-// Main game loop.
-void TowerGame::OnUpdate(int deltaMS)
-{
-	// Updates all the views
-	for(GameViewList::iterator i=m_viewList.begin(); i!=m_viewList.end(); ++i)
-	{
-		(*i)->VOnUpdate( deltaMS );
-	}
-
-	switch (m_status)
-	{
-		// Main game running status, updates processes/actors, checks for win/lose condition, spawns waves
-		case Game_Running:
-			m_processManager.UpdateProcesses(deltaMS);
-			for(ActorMap::iterator it=m_pActorMap.begin(); it != m_pActorMap.end(); it++)
-			{
-				shared_ptr<IActor> actor = it->second;
-				actor->VOnUpdate( deltaMS );
-			}
-			m_data.m_timeLeftUntilWave -= deltaMS;
-			if (m_data.m_timeLeftUntilWave <=0)
-			{
-				safeTriggerEvent(Evt_Spawn_Wave());
-				m_data.m_timeLeftUntilWave = m_data.m_waveTimeLimit;
-			}
-			if (m_data.m_curLife <= 0)
-			{
-				safeTriggerEvent(Evt_Change_GameState(Game_Pause));
-				MessageBox(NULL, (LPCWSTR)L"You have lost! MUAHAHAHAHHAHA!", (LPCWSTR)L"TOO MANY SKELETONS!", MB_OK);
-				g_App->AbortGame();
-			}
-			break;
-		
-		// Starting a new game.
-		case Game_Initializing:
-			BuildInitialScene();
-			safeTriggerEvent(Evt_Change_GameState(Game_Running));
-			m_data.m_timeLeftUntilWave = m_data.m_waveTimeLimit;
-			break;
-
-		case Game_Pause:
-			break;
-	}	
-}
-
-// Creates the basic scene for the game and sets up the tower types.
-void TowerGame::BuildInitialScene()
-{
-	if (m_luaReader.Init("test.lua") || m_luaReader.Run())
-		return; 
-	m_luaReader.ReadTowerTypes();
-	safeTriggerEvent(Evt_RebuildUI());
-	m_gameMap.CreateMap();
-}
-
-// Adds an actor to the actor list, sends event to add actors elsewhere.
-void TowerGame::VAddActor(shared_ptr<IActor> actor)
-{
-	m_pActorMap[m_LastActorId] = actor;
-	actor->VSetId(m_LastActorId);
-	m_LastActorId++;
-	m_gameMap.AddActor(actor);
-	safeQueueEvent(EventPtr (SAFE_NEW Evt_New_Actor(actor)));
-
-	if (actor->VGet()->m_Type == AT_TOWER)
-	{
-		FindNewPaths();
-	}
-}
-
-// Changes the game state.
-void TowerGame::VGameStatusChange(GameStatus status)
-{
-	m_status = status;
-}
-
-// Removes an actor from the actor list.
-void TowerGame::VRemoveActor(ActorId id)
-{
-	ActorMap::iterator it = m_pActorMap.find(id);
-	if (it == m_pActorMap.end())
-		return;
-
-	shared_ptr<IActor> actor = (*it).second;
-	bool atEnd = m_gameMap.TestRunnerAtEnd(actor);
-
-	// If the actor is a tower, find new paths for the runners and get money
-	if (actor->VGet()->m_Type == AT_TOWER)
-	{
-		FindNewPaths();
-		m_data.m_curMoney += actor->VGet()->m_cost/2;
-	}
-	// If actor is not at the ending location, add the money from it.
-	else if (!atEnd)
-		m_data.m_curMoney += actor->VGet()->m_cost/2;
-	// If actor is at end, remove life from the total.
-	else
-		m_data.m_curLife--; 
-
-	m_gameMap.RemoveActor(id);
-
-	m_pActorMap.erase(id);
-}
-
-// Moves an actor to the new location.
-void TowerGame::VMoveActor(ActorId id, const Mat4x4 &m)
-{
-	if (id < m_LastActorId)
-	{
-		shared_ptr<IActor> actor = m_pActorMap[id];
-		if (actor)
-			actor->VSetMat(m);
-	}
-}
-
-// Adds a view to the view list.
-void TowerGame::VAddView(shared_ptr<IGameView> view)
-{
-	m_viewList.push_back(view);
-}
-
-// Creates a basic square grid for the base of the map.
-void TowerGame::CreateGrid()
-{
-	shared_ptr<ActorParams> p (SAFE_NEW ActorParams());
-	p->m_Color = g_White;
-	p->m_Texture = "background2.bmp";
-	p->m_Mat = Mat4x4::g_Identity;
-	p->m_Squares = MAP_SIZE;
-	p->m_Frame = 0;
-	p->m_Width = 1;
-	p->m_Height = 0.4f;
-	p->m_ActualHeight = 1.0f;
-	p->m_ActualWidth = 1.0f;
-	p->m_Direction = 1;
-	p->m_NumFrames = 1;
-	p->m_NumDirections = 1;
-	p->m_hasTextureAlpha = false;
-	p->m_Type = AT_GROUND;
-	p->m_life = 2;
-	p->m_cost = 2;
-	p->m_speed = 3;
-	shared_ptr<IActor> actor (SAFE_NEW Actor(p));
-	VAddActor(actor);
-}
-
-// Creates a runner and sets its location to the beginning. 
-void TowerGame::CreateRunner()
-{
-	shared_ptr<ActorParams> p (SAFE_NEW ActorParams());
-	p->m_Color = g_White;
-	p->m_Texture = "skeleton.dds";
-	p->m_Mat = m_gameMap.GetGridLocation(-1);
-	p->m_Squares = 1;
-	p->m_Frame = 0;
-	p->m_Width = 1;
-	p->m_Height = 0.4f;
-	p->m_ActualHeight = 1.0f;
-	p->m_ActualWidth = 1.0f;
-	p->m_Direction = 1;
-	p->m_NumFrames = 3;
-	p->m_NumDirections = 4;
-	p->m_hasTextureAlpha = true;
-	p->m_Type = AT_RUNNER;
-	p->m_MSPerFrame = 1000 / 3;
-	p->m_LoopingAnim = false;
-	p->m_life = 5;//*(m_data.m_curWave/10);
-	p->m_cost = 2;
-	p->m_speed = 2;
-	shared_ptr<IActor> actor (SAFE_NEW Actor(p));
-	VAddActor(actor);
-}
-
-// Creates a new tower at the given location.
-void TowerGame::CreateTower(Vec3 loc)
-{
-	TowerTypeMap::iterator it = m_towerMap.find(m_curTowerType);
-	if (it == m_towerMap.end())
-		return;
-	int cost = m_towerMap[m_curTowerType].m_cost;
-
-	// Checks if there is enough money for this tower type and if it will block the path to the goal.
-	if ((m_data.m_curMoney-cost >= 0) && m_gameMap.IsLocationOccupied(loc, 2, 2))
-	{
-		shared_ptr<ActorParams> p (SAFE_NEW ActorParams());
-		p->m_Color = g_White;
-		p->m_Texture = m_towerMap[m_curTowerType].m_chartexture;
-		p->m_Squares = 1;
-		p->m_Frame = 0;
-		p->m_Width = 1;
-		p->m_Height = 0.4f;
-		p->m_ActualHeight = 2;
-		p->m_ActualWidth = 2;	
-		p->m_Mat = m_gameMap.GetGridLocation(loc, p->m_ActualHeight, p->m_ActualWidth);
-		p->m_Direction = 1;
-		p->m_NumFrames = 1;
-		p->m_NumDirections = 1;
-		p->m_hasTextureAlpha = true;
-		p->m_Type = AT_TOWER;
-		p->m_MSPerFrame = 1000 / 3;
-		p->m_LoopingAnim = false;
-		p->m_life = 2;
-		p->m_cost = cost;
-		p->m_speed = 3;
-		shared_ptr<IActor> actor;
-		
-		actor.reset(SAFE_NEW TowerActor(m_towerMap[m_curTowerType].GetParams(), p));
-		VAddActor(actor);
-	
-		m_data.m_curMoney -= p->m_cost;
-		
-	}
-}
-
-// Creates a missle to fire at the tower's target.
-void TowerGame::CreateMissile(ActorId id)
-{
-	shared_ptr<IActor> t = GetActor(id);
-	if (t->VGet()->m_Type != AT_TOWER)
-		return;
-
-	shared_ptr<TowerActor> tower = boost::dynamic_pointer_cast<TowerActor>(t);
-	SetTowerTarget(id);
-	ActorId tar = tower->GetTarget();
-	shared_ptr<IActor> target = GetActor(tar);
-
-	// Make sure the target is a runner.
-	if (target->VGet()->m_Type != AT_RUNNER)
-		return;
-	
-	shared_ptr<ActorParams> p (SAFE_NEW ActorParams());
-	p->m_Color = g_White;
-	p->m_Texture = "red.bmp";
-	p->m_Mat = tower->VGetMat();
-	p->m_Squares = 1;
-	p->m_Frame = 0;
-	p->m_Width = 0.5;
-	p->m_Height = 0.4f;
-	p->m_ActualHeight = 0.3f;
-	p->m_ActualWidth = 0.3f;
-	p->m_Direction = 1;
-	p->m_NumFrames = 3;
-	p->m_NumDirections = 4;
-	p->m_hasTextureAlpha = true;
-	p->m_Type = AT_MISSILE;
-	p->m_MSPerFrame = 1000 / 3;
-	p->m_LoopingAnim = false;
-	p->m_life = 5;
-	p->m_cost = 0;
-	p->m_speed = 8;
-	shared_ptr<IActor> actor (SAFE_NEW MissileActor(p, id, tar));
-	VAddActor(actor);
-}
-
-// Removes a tower
-void TowerGame::SellTower(Vec3 loc)
-{
-	ActorId id = m_gameMap.GetActorAtLoc(loc);
-	
-	if (id == 0)
-		return;
-
-	ActorMap::iterator i = m_pActorMap.find(id);
-
-	if (i == m_pActorMap.end())
-		return;
-
-	safeTriggerEvent(Evt_Remove_Actor(id));
-}
-
-// Sets the path to get to the goal
-void TowerGame::SetActorPath(ActorId id)
-{
-	ActorMap::iterator i = m_pActorMap.find(id);
-
-	if (i == m_pActorMap.end())
-		return;
-
-	// Checks first that the actor is not at the goal, and remove if it is.
-	shared_ptr<IActor> actor = (*i).second;
-	if (m_gameMap.TestRunnerAtEnd(actor))
-	{
-		safeQueueEvent(EventPtr (SAFE_NEW Evt_Remove_Actor(actor->VGet()->m_Id)));
-	}
-	else
-	{
-		actor->VClearQueue();
-		m_gameMap.SetActorPath(actor);
-	}
-}
-
-// Updates all the paths for the runners.
-void TowerGame::FindNewPaths()
-{
-	for(ActorMap::iterator it=m_pActorMap.begin(); it != m_pActorMap.end(); it++)
-	{
-		shared_ptr<IActor> actor = it->second;
-		if (actor->VGet()->m_Type == AT_RUNNER)
-		{
-			SetActorPath(actor->VGet()->m_Id);
-		}
-	}
-}
-
-// Changes the tower to target the closest runner.
-void TowerGame::SetTowerTarget(ActorId id)
-{
-	ActorMap::iterator i = m_pActorMap.find(id);
-
-	if (i == m_pActorMap.end())
-		return;
-
-	if ((*i).second->VGet()->m_Type == AT_TOWER)
-	{
-		shared_ptr<TowerActor> tower = boost::dynamic_pointer_cast<TowerActor> ((*i).second);
-
-		float disSq=9999.9f;
-		float range=tower->GetRange();
-		ActorId closestId=0;
-		Vec3 loc = tower->VGetMat().GetPosition();
-
-		// Iterate through the list to find the closest runner.
-		for(ActorMap::iterator it=m_pActorMap.begin(); it != m_pActorMap.end(); it++)
-		{
-			shared_ptr<IActor> actor = it->second;
-			if (actor->VGet()->m_Type == AT_RUNNER)
-			{
-				Vec3 tmpLoc = actor->VGetMat().GetPosition();
-				float tmpDis = loc.SqDistance(tmpLoc);
-				if (tmpDis < disSq )
-				{
-					disSq = tmpDis;
-					closestId = actor->VGet()->m_Id;
-				}
-			}
-		}
-
-		tower->SetTarget(closestId);
-	}
-}
-
-
-// Fires a shot at the closest runner.
-void TowerGame::ShootTar(ActorId shooter, int damage)
-{
-	ActorMap::iterator i = m_pActorMap.find(shooter);
-
-	if (i == m_pActorMap.end())
-		return;
-
-	if ((*i).second->VGet()->m_Type != AT_TOWER)
-		return;
-
-	shared_ptr<TowerActor> tower = boost::dynamic_pointer_cast<TowerActor> ((*i).second);
-
-	float disSq=9999.9f;
-	float range=tower->GetRange();
-	ActorId closestId=0;
-	Vec3 loc = tower->VGetMat().GetPosition(), dir;
-
-	// First checks to see if target is the closest
-	for(ActorMap::iterator it=m_pActorMap.begin(); it != m_pActorMap.end(); it++)
-	{
-		shared_ptr<IActor> actor = it->second;
-		if (actor->VGet()->m_Type == AT_RUNNER)
-		{
-			Vec3 tmpLoc = actor->VGetMat().GetPosition();
-			float tmpDis = sqrt((loc.x - tmpLoc.x) * (loc.x - tmpLoc.x) + (loc.z - tmpLoc.z) * (loc.z - tmpLoc.z));
-			if (tmpDis < disSq && tmpDis <= range  )
-			{
-				disSq = tmpDis;
-				closestId = actor->VGet()->m_Id;
-			}
-		}
-	}
-	if  ( closestId > 0)
-	{
-		tower->OnFire(closestId);
-	}	
-}
-
-// Creates a new wave of runners
-void TowerGame::CreateWave()
-{
-	m_data.m_curWave++;
-	int spawns = WaveSpawns(m_data.m_curWave);
-	if (spawns <= 0)
-	{
-		float num = m_data.m_curWave / 5.0f;
-		spawns = ceil(num) * 3;
-	}
-
-	for (; spawns > 0; spawns--)
-	{
-		CreateRunner();
-	}
-}
-
-// Adds a new tower type to the list.
-void TowerGame::NewTowerType(TowerType p)
-{
-	p.m_type = m_towerMap.size();
-	m_towerMap[m_towerMap.size()] = p;
-}
-
-// Gets the pointer to the actor with this id.
-shared_ptr<IActor> TowerGame::GetActor(ActorId id)
-{
-	ActorMap::iterator it = m_pActorMap.find(id);
-	shared_ptr<IActor> actor;
-
-	//actor = m_pActorMap[id];
-
-	if (it != m_pActorMap.end())
-		actor = it->second;
-
-	return actor;
-}
-
-// Deals damage to the actor of this id.
-void TowerGame::DamageActor(ActorId id, int damage)
-{
-	if (id > 2)
-		m_pActorMap[id]->VTakeDamage(damage);
-}
-
-// Applys a buff to the actor.
-void TowerGame::ApplyBuffToActor(ActorId id, shared_ptr<IBuff> buff)
-{
-	m_pActorMap[id]->VApplyBuff(buff);
-}
-
-// Used when the mouse if right clicked.
-void TowerGame::RightClick(Vec3 l)
-{
-	// Check if the location is in the grid.
-	if (m_gameMap.HashLocation(l) < 0)
-	{
-		m_selectedTower = 0;
-		safeQueueEvent(EventPtr (SAFE_NEW Evt_Change_Tower_Type(-1)));
-		return;
-	}
-
-	// Get the actor and select that tower at the location.
-	if (m_gameMap.GetActorAtLoc(l))
-	{
-		safeQueueEvent(EventPtr (SAFE_NEW Evt_Select_Tower(m_gameMap.GetActorAtLoc(l))));
-		return;
-	}
-
-	// Create a new tower at the given location.
-	m_selectedTower = 0;
-	safeQueueEvent(EventPtr (SAFE_NEW Evt_New_Tower(l)));
-}
-
-/// Sells the selected tower, if a tower is selected.
-void TowerGame::SellTower()
-{
-	if (m_selectedTower>0)
-	{
-		safeQueueEvent(EventPtr (SAFE_NEW Evt_Remove_Actor(m_selectedTower)));
-	}
-}
-
-// Upgrades the currently sellected tower with it's upgrade line.
-void TowerGame::UpgradeTower()
-{
-	ActorMap::iterator i = m_pActorMap.find(m_selectedTower);
-
-	if (i == m_pActorMap.end())
-		return;
-
-	if ((*i).second->VGet()->m_Type != AT_TOWER)
-		return;
-
-	shared_ptr<TowerActor> tower = boost::dynamic_pointer_cast<TowerActor> ((*i).second);
-
-	TowerParams t = tower->GetTowerParams();
-
-	// Checks the tower type, it is a correct type, it isn't already at max upgrade, and the player has enough money for it.
-	if (t.m_type >= 0 && t.m_type < m_towerMap.size() && t.m_nextUpgrade<t.m_maxUpgrade &&
-		(m_data.m_curMoney-m_towerMap[t.m_type].m_upgrades[t.m_nextUpgrade].m_cost >= 0) ) 
-	{
-		tower->UpgradeTower(m_towerMap[t.m_type].m_upgrades[t.m_nextUpgrade]);
-		m_data.m_curMoney -= m_towerMap[t.m_type].m_upgrades[t.m_nextUpgrade].m_cost;
-		safeTriggerEvent(Evt_Select_Tower(m_selectedTower));
-	}
-}
-
-
 /////////////////////////////////////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////////////////////////////////////
 //////////////////////////////////HumanView//////////////////////////////////////////////////
@@ -949,7 +397,6 @@ void TowerGame::UpgradeTower()
 void ListenForViewEvents(EventListenerPtr listener)
 {
 	safeAddListener( listener, EventType(Evt_New_Actor::gkName) );
-	safeAddListener( listener, EventType(Evt_Move_Actor::gkName) );
 	safeAddListener( listener, EventType(Evt_Move_Camera::gkName) );
 	safeAddListener( listener, EventType(Evt_Remove_Actor::gkName) );
 	safeAddListener( listener, EventType(Evt_Change_GameState::gkName) );
@@ -981,7 +428,7 @@ HumanView::HumanView():m_controller(),m_lastShot(0)
 	m_pCamera.reset(SAFE_NEW CameraNode(&Mat4x4::g_Identity, frustum));
 	assert(m_pScene && m_pCamera && _T("Out of memory"));
 
-	m_pScene->VAddChild(-1, m_pCamera);
+	m_pScene->VAddChild(INVALID_ACTOR_ID, m_pCamera);
 	m_pScene->SetCamera(m_pCamera);
 	m_status = Game_Initializing;
 
@@ -1043,6 +490,12 @@ void HumanView::VOnUpdate(int deltaMS)
 			break;
 	}
 
+	if (m_pScene)
+	{
+		m_pScene->SyncActors();
+		m_pScene->SyncTransforms(g_App->m_pGame->GetTransforms());
+	}
+
 	for (ScreenElementList::iterator it = m_screenElementList.begin(); it != m_screenElementList.end(); it++)
 	{
 		if (*it)
@@ -1052,6 +505,18 @@ void HumanView::VOnUpdate(int deltaMS)
 	m_controller.OnUpdate(deltaMS);
 }
 
+// Changes the view's status, tells the player and closes the game once it is lost.
+void HumanView::VGameStatusChange(GameStatus status)
+{
+	m_status = status;
+
+	if (status == Game_Over)
+	{
+		MessageBox(NULL, (LPCWSTR)L"You have lost! MUAHAHAHAHHAHA!", (LPCWSTR)L"TOO MANY SKELETONS!", MB_OK);
+		g_App->AbortGame();
+	}
+}
+
 // Sets view id.
 void HumanView::VOnAttach(GameViewId vid)
 {
@@ -1228,7 +693,7 @@ void HumanView::VOnLostDevice()
 // Adds an actor to the scene node graph
 void HumanView::VAddActor(shared_ptr<IActor> actor)
 {
-	shared_ptr<ISceneNode> object (SAFE_NEW PlaneNode(actor->VGet()));
+	shared_ptr<ISceneNode> object (SAFE_NEW PlaneNode(actor->VGetRenderParams()));
 	// If the actor is one of the runners, add a life bar above it.
 	if (actor && actor->VGet()->m_Type == AT_RUNNER)
 	{
@@ -1282,16 +747,6 @@ void HumanView::VPopScreen()
 	m_screenElementList.pop_back();
 }
 
-// Moves the scene node to the correct location
-void HumanView::VMoveActor(ActorId id, Mat4x4 const &mat)
-{
-    shared_ptr<ISceneNode> node = m_pScene->FindActor(id);
-	if (node)
-	{
-		node->VSetTransform(&mat);
-	}
-}
-
 // Moves the camera to the changed location.
 void HumanView::MoveCamera(Mat4x4 const &change)
 {
@@ -1348,14 +803,14 @@ void HumanView::MoveCamera(Vec3 pos)
 }
 
 // Adds a new "shot" effect to the scene node graph.
-void HumanView::AddShot(ActorId id, int time, Vec3 start, Vec3 end, std::string texture)
+void HumanView::AddShot(ActorId id, int time, Vec3 start, Vec3 end, StringId texture)
 {
 	Mat4x4 s,e;
 	s.BuildTranslation(start);
 	e.BuildTranslation(end);
 	shared_ptr<ISceneNode> object (SAFE_NEW ShotNode(id, time, m_lastShot, texture, s, e));
 	++m_lastShot;
-	m_pScene->AddChild(-1, object);
+	m_pScene->AddChild(INVALID_ACTOR_ID, object);
 	object->VOnRestore(&*m_pScene);
 }
 
@@ -1374,356 +829,54 @@ void HumanView::TowerChange(int type)
 	if (type >= 0)
 	{
 		shared_ptr<ActorParams> p (SAFE_NEW ActorParams());
-		p->m_Color = g_White;
-		p->m_Texture = "square.dds";
+		ActorRenderParams r;
+		r.m_Color = g_White;
+		r.m_Texture = InternString("square.dds");
 		p->m_Mat = Mat4x4::g_Identity;
-		p->m_Squares = 1;
-		p->m_Frame = 0;
-		p->m_Width = 1;
-		p->m_Height = 0.4f;
+		r.m_Squares = 1;
+		r.m_Frame = 0;
+		r.m_Width = 1;
+		r.m_Height = 0.4f;
 		p->m_ActualHeight = 2;
 		p->m_ActualWidth = 2;
 		p->m_Direction = 1;
-		p->m_NumFrames = 1;
-		p->m_NumDirections = 1;
-		p->m_hasTextureAlpha = true;
+		r.m_NumFrames = 1;
+		r.m_NumDirections = 1;
+		r.m_hasTextureAlpha = true;
 		p->m_Type = AT_EFFECT;
 		p->m_life = 0;
 		p->m_cost = 0;
 		p->m_speed = 0;
-		shared_ptr<IActor> actor (SAFE_NEW EffectActor(p, g_App->m_pGame->GetTowerData(type).m_range));
-		g_App->m_pGame->VAddActor(actor);
-		m_mouseOver = actor;
-	}
-}
-
-// Selects the tower with the given id.
-void HumanView::SelectTower(ActorId id)
-{
-	m_humanUI->SelectTower(id);
-	// clears the old mouse over data
-	if (m_mouseOver)
-	{
-		ActorId mid = m_mouseOver->VGet()->m_Id;
-		m_mouseOver.reset();
-		safeQueueEvent(EventPtr (SAFE_NEW Evt_Remove_Actor(mid)));
-	}
-}
-
-// Used for the mouse over the towers.
-void HumanView::MouseMove(Vec3 pos)
-{
-	if (m_mouseOver)
-	{
-		Mat4x4 m (g_App->m_pGame->m_gameMap.GetGridLocation(pos, m_mouseOver->VGet()->m_ActualHeight, m_mouseOver->VGet()->m_ActualWidth));
-		safeQueueEvent(EventPtr (SAFE_NEW Evt_Move_Actor(m_mouseOver->VGet()->m_Id, m) ) );
-	}
-}
-
-/////////////////////////////////////////////////////////////////////////////////////////////
-/////////////////////////////////////////////////////////////////////////////////////////////
-//////////////////////////////////Actor//////////////////////////////////////////////////////
-/////////////////////////////////////////////////////////////////////////////////////////////
-/////////////////////////////////////////////////////////////////////////////////////////////
-
-// Default constructor.
-Actor::Actor()
-{
-	shared_ptr<ActorParams> p;
-	m_params = p;
-	m_elapsedTime = 0;
-	m_timeToStart = rand() % 3000;
-}
-
-// Builds the actor out from the actor params.
-Actor::Actor(shared_ptr<ActorParams> p)
-{
-	m_params = p;
-	m_elapsedTime = 0;
-	m_timeToStart = rand() % 3000;
-}
-
-// Updates the buffs on the actor and then checks if there is place set to move the actor to.
-void Actor::VOnUpdate(int elapsedTime)
-{
-	// move the character if there is a matrix
-	const int frameUpdate = 10;
-
-	for (BuffList::iterator it = m_buffs.begin(); it != m_buffs.end();)
-	{
-		if ((*it)->VOnUpdate(elapsedTime))
-		{
-			(*it)->VRemove();
-			it = m_buffs.erase(it);
-		}
-		else
-			it++;
-	}
-
-	if (m_timeToStart > 0)
-	{
-		m_timeToStart -= elapsedTime;
-		return;
-	}
-	
-	// Don't need to go further if there is no location to move to.
-	if (!m_moveQueue.empty())
-	{
-		m_elapsedTime += elapsedTime;
-		if (m_elapsedTime > frameUpdate)
-		{
-			Vec3 A = m_params->m_Mat.GetPosition();
-			Vec3 B = m_moveQueue.back().GetPosition();
-
-			// Finds the distance from the current location to the next location
-			float k = A.Distance(B);
-			// If the actor is far from the destination, move the actor
-			if (k > 0.1f)
-			{
-				m_params->m_LoopingAnim=true;
-				if (k > 0.9f)
-					VSetDirection(B);
-
-				// Finds how much to move based on how fast the actor moves and how long it has been.
-				float distanceToMove = m_elapsedTime / frameUpdate;
-				m_elapsedTime -= distanceToMove * frameUpdate;
-				float speed = m_params->m_speed * 0.003;
-				float d = (speed * distanceToMove) / k;
-
-				// Make sure it doesn't go over the distance needed.
-				if (d > k)
-					d = k;
-
-				// Find the actor's new location
-				Vec3 C = A + (B - A)*d;
-
-				//C.z = B.z;
-				Mat4x4 moveTo = Mat4x4::g_Identity;
-				moveTo.SetPosition(C);
-
-				safeTriggerEvent(Evt_Move_Actor(m_params->m_Id,moveTo));
-			}
-			// If the actor is close to the destination, remove that destination from the queue
-			else
-			{
-				m_params->m_LoopingAnim=false;
-				m_moveQueue.pop_back();
-				m_elapsedTime = 0;
-			}
-		}
-	}
-	else
-	{
-		// If the actor is a runner and it doesn't have a path already, find one.
-		m_elapsedTime = 0;
-		if (m_params->m_Type == AT_RUNNER)
-			safeQueueEvent(EventPtr (SAFE_NEW Evt_Set_Path(m_params->m_Id)));
-		
-	}
-}
-
-// Will face the actor in the direction given from its current location
-void Actor::VSetDirection(Vec3 B)
-{
-	Vec3 A = m_params->m_Mat.GetPosition();
-	float direction = atan2(B.z - A.z, B.x - A.x);
-	if (direction < 0)
-		direction =  2*3.1415 + direction;
-
-	if (direction > 0 && direction < 0.785375)
-	{
-		m_params->m_Direction = 1;
-	}
-	else
-	if (direction > 0.785375 && direction < 2.356125)
-	{
-		m_params->m_Direction = 0;
-	}
-	else
-	if (direction > 2.356125 && direction < 3.926875)
-	{
-		m_params->m_Direction = 3;
-	}
-	else
-	if (direction > 3.926875 && direction < 5.497625)
-	{
-		m_params->m_Direction = 2;
-	}
-	else
-	if (direction > 5.497625)
-	{
-		m_params->m_Direction = 1;
-	}
-}
-
-// Gives damage to the actor and sends an event if it dies.
-bool Actor::VTakeDamage(int damage)
-{
-	m_params->m_life -= damage;
-	if (m_params->m_life < 0)
-	{
-		safeQueueEvent(EventPtr (SAFE_NEW Evt_Remove_Actor(m_params->m_Id)));
-		return 0;
-	}
-
-	return 1;
-}
-
-// Adds a buff on the actor. Can only have 1 buff of each type going at a time.
-void Actor::VApplyBuff(shared_ptr<IBuff> buff)
-{
-	for (BuffList::iterator it = m_buffs.begin(); it != m_buffs.end(); it++)
-		if ( (*it)->VGetType() == buff->VGetType())
-			return;
-
-	m_buffs.push_back(buff);
-	buff->VApply();
-}
-
-
-/////////////////////////////////////////////////////////////////////////////////////////////
-/////////////////////////////////////////////////////////////////////////////////////////////
-//////////////////////////////////TowerActor/////////////////////////////////////////////////
-/////////////////////////////////////////////////////////////////////////////////////////////
-/////////////////////////////////////////////////////////////////////////////////////////////
-
-// Updates the tower by running the lua script for it.
-void TowerActor::VOnUpdate(int deltaMS)
-{	
-	m_luaScript.OnUpdate(deltaMS);
-}
-
-// Sets the target the tower is pointing at
-void TowerActor::SetTarget(ActorId id)
-{
-	m_curTarget = id;
-	shared_ptr<IActor> runner = g_App->m_pGame->GetActor(id);
-	VSetDirection(runner->VGetMat().GetPosition());
-	m_luaScript.SetTarget(id);
-}
-
-// Fires a shot at the current target
-void TowerActor::OnFire(ActorId id)
-{
-	shared_ptr<IActor> runner = g_App->m_pGame->GetActor(id);
-	if (runner && runner->VGet()->m_Type == AT_RUNNER)
-	{
-		m_curTarget = id;
-		VSetDirection(runner->VGetMat().GetPosition());
-		m_luaScript.Fire(m_curTarget);
-		//safeTriggerEvent(Evt_Damage_Actor(id, m_towerParams.m_damage));
-		safeTriggerEvent(Evt_Shot(VGet()->m_Id, 100, VGetMat().GetPosition(), runner->VGetMat().GetPosition(), m_towerParams.m_shottexture));
-	}
-}
-
-// Upgrades the tower with the upgrade sent
-void TowerActor::UpgradeTower(Upgrade u)
-{
-	m_towerParams.m_damage += u.m_damage;
-	m_towerParams.m_cost += u.m_cost;
-	m_towerParams.m_reloadTime += u.m_reload;
-	m_towerParams.m_range += u.m_reload;
-	m_towerParams.m_nextUpgrade++;
-	m_params->m_cost += u.m_cost;
-	m_luaScript.UpgradeTower(u);
-}
-
-// Rotates the tower to face the direction given.
-void TowerActor::VSetDirection(Vec3 B)
-{
-	Vec3 A = m_params->m_Mat.GetPosition();
-	float direction = atan2(B.z - A.z, B.x - A.x);
-	if (direction < 0)
-		direction =  2*3.1415 + direction;
-	Mat4x4 m;
-	m = Mat4x4::g_Identity;
-	m.BuildRotationY(-direction);
-	m_params->m_Mat.BuildTranslation(A);
-	m_params->m_Mat = m  * m_params->m_Mat;
-}
-
-/////////////////////////////////////////////////////////////////////////////////////////////
-/////////////////////////////////////////////////////////////////////////////////////////////
-//////////////////////////////////MissileActor///////////////////////////////////////////////
-/////////////////////////////////////////////////////////////////////////////////////////////
-/////////////////////////////////////////////////////////////////////////////////////////////
-
-// Moves the missile towards its target and does damage if it gets close.
-// Similar to the normal actor movement.
-void MissileActor::VOnUpdate(int deltaMS)
-{
-	const int frameUpdate = 10;
-
-	shared_ptr<IActor> tar = g_App->m_pGame->GetActor(m_target);
-
-	if (tar)
-		m_location = tar->VGetMat();
-
-	m_elapsedTime += deltaMS;
-	if (m_elapsedTime > frameUpdate)
-	{
-		Vec3 A = m_params->m_Mat.GetPosition();
-		Vec3 B = m_location.GetPosition();
-
-		// Gets the distance from the actor and its destination.
-		float k = A.Distance(B);
-		if (k > 0.1f)
-		{
-			m_params->m_LoopingAnim=true;
-			if (k > 0.9f)
-				VSetDirection(B);
-
-			// Finds the distance to move based on how much time has passed.
-			float distanceToMove = m_elapsedTime / frameUpdate;
-			m_elapsedTime -= distanceToMove * frameUpdate;
-			float speed = m_params->m_speed * 0.003;
-			float d = (speed * distanceToMove) / k;
-
-			if (d > k)
-				d = k;
-
-			Vec3 C = A + (B - A)*d;
-
-			//C.z = B.z;
-			Mat4x4 moveTo = Mat4x4::g_Identity;
-			moveTo.SetPosition(C);
-
-			safeTriggerEvent(Evt_Move_Actor(m_params->m_Id,moveTo));
-		}
-		else
-		{
-			// If the missile is close to its destination, then it will damage the target and remove itself.
-			m_params->m_LoopingAnim=false;
-			m_elapsedTime = 0;
-			shared_ptr<IActor> t = g_App->m_pGame->GetActor(m_tower);
-			if (t && t->VGet()->m_Type == AT_TOWER)
-			{
-				shared_ptr<TowerActor> tower = boost::dynamic_pointer_cast<TowerActor> (t);
-				tower->OnFire(m_target);
-			}
-			safeQueueEvent(EventPtr (SAFE_NEW Evt_Remove_Actor(m_params->m_Id)));
-		}
+		shared_ptr<IActor> actor (SAFE_NEW EffectActor(p, g_App->m_pGame->GetTowerData(type).m_range));
+		actor->VSetRenderParams(r);
+		g_App->m_pGame->VAddActor(actor);
+		m_mouseOver = actor;
 	}
 }
 
-// Sets the target for the missile
-void MissileActor::SetTarget(ActorId id)
+// Selects the tower with the given id.
+void HumanView::SelectTower(ActorId id)
 {
-	m_curTarget = id;
-	shared_ptr<IActor> runner = g_App->m_pGame->GetActor(id);
-	VSetDirection(runner->VGetMat().GetPosition());
+	m_humanUI->SelectTower(id);
+	// clears the old mouse over data
+	if (m_mouseOver)
+	{
+		ActorId mid = m_mouseOver->VGet()->m_Id;
+		m_mouseOver.reset();
+		safeQueueEvent(EventPtr (SAFE_NEW Evt_Remove_Actor(mid)));
+	}
 }
 
-// Missiles on fire function. Used to conform to TowerActor, but without the luascript
-void MissileActor::OnFire(ActorId id)
+// Used for the mouse over the towers.
+void HumanView::MouseMove(Vec3 pos)
 {
-	shared_ptr<IActor> runner = g_App->m_pGame->GetActor(id);
-	m_curTarget = id;
-	VSetDirection(runner->VGetMat().GetPosition());
-	safeTriggerEvent(Evt_Shot(VGet()->m_Id, 100, VGetMat().GetPosition(), runner->VGetMat().GetPosition(), m_towerParams.m_shottexture));
+	if (m_mouseOver)
+	{
+		Mat4x4 m (g_App->m_pGame->m_gameMap.GetGridLocation(pos, m_mouseOver->VGet()->m_ActualHeight, m_mouseOver->VGet()->m_ActualWidth));
+		safeQueueEvent(EventPtr (SAFE_NEW Evt_Move_Actor(m_mouseOver->VGet()->m_Id, m) ) );
+	}
 }
 
-
 /////////////////////////////////////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////////////////////////////////////
 //////////////////////////////////HumanInterfaceController///////////////////////////////////
@@ -1967,535 +1120,10 @@ void HumanInterfaceController::OnMouseMove(const CPoint &mousePos)
 
 /////////////////////////////////////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////////////////////////////////////
-//////////////////////////////////Map////////////////////////////////////////////////////////
-/////////////////////////////////////////////////////////////////////////////////////////////
-/////////////////////////////////////////////////////////////////////////////////////////////
-
-// Default constructor 
-Map::Map():m_start(MAP_SIZE*HALF_MAP_SIZE), m_end(MAP_SIZE*HALF_MAP_SIZE+(MAP_SIZE-1))
-{
-	memset(&m_grid,0,sizeof(m_grid));
-}
-
-// Checks if the actor is in a valid spot and fills those in on the map grid.
-bool Map::AddActor(shared_ptr<IActor> actor)
-{
-	if (actor->VGet()->m_Type == AT_TOWER)
-	{
-		ActorId id = actor->VGet()->m_Id;
-		Mat4x4 mat = actor->VGetMat();
-		Vec3 loc = mat.GetPosition();
-		int	mapPlace = HashLocation(loc);
-		if (mapPlace >= 0)
-		{
-			int p=0;
-			for (int i = actor->VGet()->m_ActualHeight-1; i >= 0; i--)
-			{
-				for (int j = actor->VGet()->m_ActualWidth-1; j >= 0; j--)
-				{
-					p = mapPlace-MAP_SIZE*i-j;
-					m_grid[p] = id;
-				}
-			}
-			m_grid[mapPlace] = id;
-			return true;
-		}
-	}
-	
-	return false;
-}
-
-
-// Finds the map grid index based on the 3d location
-int Map::HashLocation(Vec3 location)
-{
-	bool no=true;
-	int x = floor(location.x);
-	x+=HALF_MAP_SIZE;
-	if (x<0)
-		no=false;
-	if (x>=MAP_SIZE)
-		no=false;
-
-	int y = floor(location.z);		
-	y+=HALF_MAP_SIZE;
-
-	if (y<0)
-		no=false;
-	if (y>=MAP_SIZE)
-		no=false;
-	if (no)
-		return x + (y*MAP_SIZE);
-	else
-		return -1;
-}
-
-// Finds the location for the center of the square for the vector given.
-Mat4x4 Map::GetGridLocation(Vec3 v)
-{
-	int x = floor(v.x);
-	int y = floor(v.z);	
-	Mat4x4 m;
-	m.BuildTranslation(x+0.5f, 0, y+0.5f);
-
-	return m;
-}
-
-// Gets the location for the center of the square with height and width for the vector
-Mat4x4 Map::GetGridLocation(Vec3 v, int height, int width)
-{
-	int x = floor(v.x);
-	int y = floor(v.z);	
-	Mat4x4 m;
-	m.BuildTranslation(x+width/2.0f, 0, y+height/2.0f);
-
-	return m;
-}
-
-// Gets the location for the map grid index
-Mat4x4 Map::GetGridLocation(int i)
-{
-	bool s = false;
-	Mat4x4 m = Mat4x4::g_Identity;
-
-	if (i < 0)
-	{
-		i = m_start;
-		s = true;
-	}
-
-	if (i < MAP_SIZE * MAP_SIZE)
-	{
-		int x = i % MAP_SIZE;
-		int y = i / MAP_SIZE;
-		x -= HALF_MAP_SIZE;
-		y -= HALF_MAP_SIZE;
-		
-		if (s)
-			x--;
-
-		m.BuildTranslation(x+0.5f, 0, y+0.5f);
-	}
-
-	return m;
-}
-
-// Tests if the locatin will block movement to the end location from the beginning
-bool Map::CheckLocation(Vec3 loc)
-{
-	bool b = false;
-	int t = HashLocation(loc);
-	shared_ptr<IActor> p;
-	if (t >= 0)
-	{
-		m_grid[t] = -1;
-		b = TestLocation(m_end, m_start, p);
-		m_grid[t] = 0;
-	}
-	return b;
-}
-
-// Checks if the location is filled and if it blocks
-bool Map::IsLocationOccupied(Vec3 loc)
-{
-	int t = HashLocation(loc);
-	
-	if (m_grid[t] == 0)
-	{
-		return CheckLocation(loc);
-	}
-
-	return false;
-}
-
-// Checks if the location is filled and if it blocks for a square
-bool Map::IsLocationOccupied(Vec3 loc, int height, int width)
-{
-	int t = HashLocation(loc);
-	t += MAP_SIZE + 1;
-	bool test = true;
-	int	p=0;
-
-	for (int i = height-1; i >= 0; i--)
-	{
-		for (int j = width-1; j >= 0; j--)
-		{
-			p = t-MAP_SIZE*i-j;
-			int id = m_grid[p];
-			if (m_grid[p] != 0)
-				test = false;
-			else
-				m_grid[p] = -1;
-		}
-	}
-	
-	if (test)
-		test = CheckLocation(loc);
-
-	for (int i = height-1; i >= 0; i--)
-	{
-		for (int j = width-1; j >= 0; j--)
-		{
-			p = t-MAP_SIZE*i-j;
-			if (m_grid[p] == -1)
-				m_grid[p] = 0;
-		}
-	}
-
-	return test;
-}
-
-// Uses the A* algorithm to find a path from the start node to the end node.
-// If the actor is given, it will give that actor the path for the start to the end.
-bool Map::TestLocation(int endNode, int startNode, shared_ptr<IActor> actor)
-{
-	bool end = false;
-	SearchNodeMap openList, closedList;
-	SearchNode cur;
-	cur.loc = startNode;
-	// finds the temp numbers for the Manhattan distance.
-	int endX = endNode % MAP_SIZE, endY = endNode / MAP_SIZE;
-	int dis = 9999;
-	openList[startNode] = cur;
-	SearchNodeMap::iterator it, itClosed;
-
-	// While there are nodes left to check and we are not at the end.
-	while (!openList.empty() && !end)
-	{
-		// Finds the shortest distance node.
-		dis = 9999;
-		for (it = openList.begin(); it != openList.end(); it++)
-		{
-			if ((*it).second.F <= dis)
-			{
-				cur = (*it).second;
-				dis = (*it).second.F;
-			}
-		}
-
-		// Checks if the current square is the end square
-		if (cur.loc == endX + endY * MAP_SIZE)
-			end = true;
-
-		// Removes the current node from the open list and adds to the closed
-		openList.erase(cur.loc);
-		closedList[cur.loc] = cur;
-
-		// Checks the 4 squares around it, up, down, left and right.
-		for (int i = 0; i < 4; i++)
-		{
-			int sign = (i >= 2 ? -1 : 1);
-			int test = cur.loc;
-			int x = test % MAP_SIZE;
-			int y = test / MAP_SIZE;
-
-			if (i % 2 == 0)
-			{
-				test += sign;
-				test = min(test, ((y+1)*MAP_SIZE));
-				test = max(test, (y * MAP_SIZE));
-			}
-			else
-			{
-				test += sign*MAP_SIZE;
-			}
-
-			// Make sure the test square is on the map and not occupied.
-			if ((test >= 0) && (test < MAP_SIZE*MAP_SIZE) && m_grid[test] == 0)
-			{
-				// Looks for that suqare in the closed set.
-				itClosed = closedList.find(test);
-				if (itClosed == closedList.end())
-				{
-					// Looks for the node in the open set
-					it = openList.find(test);
-					if (it == openList.end())
-					{
-						// If not in the open set, create a new node
-						SearchNode tmp;
-						tmp.G = cur.G + 1;
-						tmp.H = abs(x - endX) + abs(y - endY);
-						tmp.F = tmp.G + tmp.H;
-						tmp.parent = cur.loc;
-						tmp.loc = test;
-
-						// Adds the node to the open list.
-						openList[test] = tmp;
-					}
-					else
-					{
-						// If already in the open set, update the G, H, and F numbers.
-						if ((*it).second.G > cur.G + 10)
-						{
-							(*it).second.G = cur.G + 10;
-							(*it).second.F = (*it).second.G + (*it).second.H;
-							(*it).second.parent = cur.loc;
-						}
-					}
-				}
-			}
-		}
-
-	}
-
-	// If we are at the end and we have an actor, set up the path for it to follow
-	if (end && actor && cur.loc == endNode)
-	{
-		while (cur.parent >= 0)
-		{
-			actor->VQueuePosition(GetGridLocation(cur.loc));
-			cur = closedList[cur.parent];
-		}
-	}
-
-	// Returns true if at the end.
-	return end;
-}
-
-
-// Sets the actor's path from its current location to the end.
-void Map::SetActorPath(shared_ptr<IActor> actor)
-{
-	Vec3 v = actor->VGet()->m_Mat.GetPosition();
-	int start = HashLocation(v);
-	if (start >= 0)
-		TestLocation(m_end, start, actor);
-	else
-	{
-		TestLocation(m_end, m_start, actor);
-		actor->VQueuePosition(GetGridLocation(m_start));
-	}
-}
-
-// Tests if the runner is at the end.
-bool Map::TestRunnerAtEnd(shared_ptr<IActor> actor)
-{
-	Vec3 v = actor->VGet()->m_Mat.GetPosition();
-	int test = HashLocation(v);
-	if (test == m_end)
-		return true;
-	
-	return false;
-}
-
-// Finds the actor at the given location
-ActorId Map::GetActorAtLoc(Vec3 v)
-{
-	int test = HashLocation(v);
-	return m_grid[test];
-}
-
-// Removes the actor from the map
-bool Map::RemoveActor(ActorId id)
-{
-	int i = 0;
-	bool end=false;
-
-	while (i < MAP_SIZE*MAP_SIZE)
-	{
-		if (m_grid[i] == id)
-		{
-			m_grid[i] = 0;
-			end = (i == m_end ? false : true);
-		}
-		i++;
-	}
-
-	return end;
-}
-
-// Creates the scene node elements for the map
-void Map::CreateMap()
-{
-	// Base background for the map
-	shared_ptr<ActorParams> p (SAFE_NEW ActorParams());
-	p->m_Color = g_White;
-	p->m_Texture = "background2.bmp";
-	p->m_Mat = Mat4x4::g_Identity;
-	p->m_Squares = MAP_SIZE;
-	p->m_Frame = 0;
-	p->m_Width = 1;
-	p->m_Height = 0.4f;
-	p->m_ActualHeight = 1.0;
-	p->m_ActualWidth = 1.0f;
-	p->m_Direction = 1;
-	p->m_NumFrames = 1;
-	p->m_NumDirections = 1;
-	p->m_hasTextureAlpha = false;
-	p->m_Type = AT_GROUND;
-	p->m_life = 2;
-	p->m_cost = 2;
-	p->m_LoopingAnim = true;
-	shared_ptr<IActor> actor (SAFE_NEW Actor(p));
-
-	g_App->m_pGame->VAddActor(actor);
-
-	// A red square for the starting location.
-	p.reset(SAFE_NEW ActorParams());
-	p->m_Color = g_Red;
-	p->m_Texture = "red.bmp";
-	p->m_Mat = GetGridLocation(m_start);
-	p->m_Squares = 1;
-	p->m_Frame = 0;
-	p->m_Width = 1;
-	p->m_Height = 0.4f;
-	p->m_ActualHeight = 1.0f;
-	p->m_ActualWidth = 1.0f;
-	p->m_Direction = 1;
-	p->m_NumFrames = 1;
-	p->m_NumDirections = 1;
-	p->m_hasTextureAlpha = false;
-	p->m_Type = AT_GROUND;
-	p->m_life = 2;
-	p->m_cost = 2;
-	actor.reset(SAFE_NEW Actor(p));
-	g_App->m_pGame->VAddActor(actor);
-
-	// A blue square for the end location.
-	p.reset(SAFE_NEW ActorParams());
-	p->m_Color = g_Blue;
-	p->m_Texture = "blue.bmp";
-	p->m_Mat = GetGridLocation(m_end);
-	p->m_Squares = 1;
-	p->m_Frame = 0;
-	p->m_Width = 1;
-	p->m_Height = 0.4f;
-	p->m_ActualHeight = 1.0f;
-	p->m_ActualWidth = 1.0f;
-	p->m_Direction = 1;
-	p->m_NumFrames = 1;
-	p->m_NumDirections = 1;
-	p->m_hasTextureAlpha = false;
-	p->m_Type = AT_GROUND;
-	p->m_life = 2;
-	p->m_cost = 2;
-	actor.reset(SAFE_NEW Actor(p));
-	g_App->m_pGame->VAddActor(actor);
-}
-
-
-/////////////////////////////////////////////////////////////////////////////////////////////
-/////////////////////////////////////////////////////////////////////////////////////////////
-//////////////////////////////////GameLogicListener//////////////////////////////////////////
+//////////////////////////////////GameViewListener///////////////////////////////////////////
 /////////////////////////////////////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////////////////////////////////////
 
-// Event listener for the game logic, mostly just calls the game's functions.
-bool GameLogicListener::HandleEvent(Event const & e)
-{
-	if (strcmp(e.getType().getName(), Evt_Remove_Actor::gkName)==0)
-	{
-		EvtData_Remove_Actor *data = e.getData<EvtData_Remove_Actor>();
-		m_game->VRemoveActor(data->m_id);
-	}
-	else
-	if (strcmp(e.getType().getName(), Evt_New_Runner::gkName)==0)
-	{
-		m_game->CreateRunner();
-	}
-	else
-	if (strcmp(e.getType().getName(), Evt_New_Tower::gkName)==0)
-	{
-		EvtData_New_Tower *data = e.getData<EvtData_New_Tower>();
-		m_game->CreateTower(data->m_pos);
-	}
-	else
-	if (strcmp(e.getType().getName(), Evt_Move_Actor::gkName)==0)
-	{
-		EvtData_Move_Actor *data = e.getData<EvtData_Move_Actor>();
-		m_game->VMoveActor(data->m_id, data->m_Mat);
-	}
-	else
-	if (strcmp(e.getType().getName(), Evt_Change_GameState::gkName)==0)
-	{
-		EvtData_Change_GameState *data = e.getData<EvtData_Change_GameState>();
-		m_game->VGameStatusChange(data->m_state);
-	}
-	else
-	if (strcmp(e.getType().getName(), Evt_Set_Path::gkName)==0)
-	{
-		EvtData_Set_Path *data = e.getData<EvtData_Set_Path>();
-		m_game->SetActorPath(data->m_id);
-	}
-	else
-	if (strcmp(e.getType().getName(), Evt_Find_Closest_Tar::gkName) == 0)
-	{
-		EvtData_Closest_Tar *data = e.getData<EvtData_Closest_Tar>();
-		m_game->SetTowerTarget(data->m_id);
-	}
-	else
-	if (strcmp(e.getType().getName(), Evt_Shoot_Tar::gkName) == 0)
-	{
-		EvtData_Shoot_Tar *data = e.getData<EvtData_Shoot_Tar>();
-		m_game->ShootTar(data->m_shooterId, data->m_damage);
-	}
-	else
-	if (strcmp(e.getType().getName(), Evt_Sell_Tower::gkName) == 0 )
-	{
-		EvtData_Sell_Tower *data = e.getData<EvtData_Sell_Tower>();
-		m_game->SellTower(data->m_pos);
-	}
-	else
-	if (strcmp(e.getType().getName(), Evt_Spawn_Wave::gkName) == 0 )
-	{
-		m_game->CreateWave();
-	}
-	else
-	if (strcmp(e.getType().getName(), Evt_Change_Tower_Type::gkName) == 0 )
-	{
-		EvtData_Change_Tower_Type *data = e.getData<EvtData_Change_Tower_Type>();
-		m_game->ChangeTowerType(data->m_type);
-	}
-	else
-	if (strcmp(e.getType().getName(), Evt_New_Tower_Type::gkName) == 0 )
-	{
-		EvtData_New_Tower_Type *data = e.getData<EvtData_New_Tower_Type>();
-		m_game->NewTowerType(data->m_params);
-	}
-	else
-	if (strcmp(e.getType().getName(), Evt_Damage_Actor::gkName) == 0 )
-	{
-		EvtData_Damage_Actor *data = e.getData<EvtData_Damage_Actor>();
-		m_game->DamageActor(data->m_id, data->m_damage);
-	}
-	else
-	if (strcmp(e.getType().getName(), Evt_Apply_Buff::gkName) == 0 )
-	{
-		EvtData_Apply_Buff *data = e.getData<EvtData_Apply_Buff>();
-		m_game->ApplyBuffToActor(data->m_buff->VGetActorId(), data->m_buff);
-	}
-	else
-	if (strcmp(e.getType().getName(), Evt_Create_Missile::gkName) == 0 )
-	{
-		EvtData_Create_Missile *data = e.getData<EvtData_Create_Missile>();
-		m_game->CreateMissile(data->m_id);
-	}
-	else
-	if (strcmp(e.getType().getName(), Evt_Left_Click::gkName) == 0 )
-	{
-		EvtData_Right_Click *data = e.getData<EvtData_Right_Click>();
-		m_game->RightClick(data->m_loc);
-	}
-	else
-	if (strcmp(e.getType().getName(), Evt_Select_Tower::gkName) == 0 )
-	{
-		EvtData_Select_Tower *data = e.getData<EvtData_Select_Tower>();
-		m_game->SelectTower(data->m_id);
-	}
-	else
-	if (strcmp(e.getType().getName(), Evt_Sell_Selected_Tower::gkName) == 0 )
-	{
-		m_game->SellTower();
-	}
-	else
-	if (strcmp(e.getType().getName(), Evt_Upgrade_Selected_Tower::gkName) == 0 )
-	{
-		m_game->UpgradeTower();
-	}
-
-	return false;
-}
-
 // Event listener for the game view, mostly just calls the view's functions.
 bool GameViewListener::HandleEvent(Event const & e)
 {
@@ -2511,12 +1139,6 @@ bool GameViewListener::HandleEvent(Event const & e)
 		m_view->VRemoveActor(data->m_id);
 	}
 	else
-	if (strcmp(e.getType().getName(), Evt_Move_Actor::gkName)==0)
-	{
-		EvtData_Move_Actor *data = e.getData<EvtData_Move_Actor>();
-		m_view->VMoveActor(data->m_id, data->m_Mat);
-	}
-	else
 	if (strcmp(e.getType().getName(), Evt_Move_Camera::gkName)==0)
 	{
 		EvtData_Move_Camera *data = e.getData<EvtData_Move_Camera>();
@@ -2867,47 +1489,3 @@ void HumanUI::BuildInitialDialogs(int numButtons)
 	m_TowerType.GetStatic(5)->SetElement(0, el);
 	m_TowerType.SetVisible(false);
 }
-
-
-
-/////////////////////////////////////////////////////////////////////////////////////////////
-/////////////////////////////////////////////////////////////////////////////////////////////
-//////////////////////////////////Slow///////////////////////////////////////////////////////
-/////////////////////////////////////////////////////////////////////////////////////////////
-/////////////////////////////////////////////////////////////////////////////////////////////
-
-// Changes the actor's speed when applied.
-void Slow::VApply()
-{
-	shared_ptr<IActor> actor = g_App->m_pGame->GetActor(m_id);
-
-	if (actor)
-	{
-		int speed = actor->VGet()->m_speed;
-		speed = speed/2;
-		actor->VGet()->m_speed = speed;
-	}
-}
-
-// Resets the actor's speed when removed.
-void Slow::VRemove()
-{
-	shared_ptr<IActor> actor = g_App->m_pGame->GetActor(m_id);
-
-	if (actor)
-	{
-		int speed = actor->VGet()->m_speed;
-		speed = speed * 2;
-		actor->VGet()->m_speed = speed;
-	}
-}
-
-// Slowly ticks down until it is removed.
-bool Slow::VOnUpdate(int deltaMS)
-{
-	m_time -= deltaMS;
-	if (m_time <= 0)
-		return true;
-
-	return false;
-}
\ No newline at end of file
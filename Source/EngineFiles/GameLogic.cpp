@@ -0,0 +1,1169 @@
+/*
+The game logic: the TowerGame class, the map and the actors that live on it.
+None of this talks to the OS, the display or the audio directly, so it can be
+run with or without a HumanView attached (see TowerSim for the headless runner).
+*/
+
+#include "StdHeader.h"
+#include "GameLogic.h"
+#include "ObjectPool.h"
+#include "ResourceCache/ResCache2.h"
+#include <time.h>
+
+
+// The running game, set up by the TowerGame constructor.
+static TowerGame *g_TowerGame = NULL;
+
+// Where the game's actors and their params are made. The pools aren't part
+// of the game, views and queued events can still hold actors after it's gone.
+static ObjectPool<ActorParams>	g_paramsPool(512);
+static ObjectPool<Actor>		g_actorPool(256);
+static ObjectPool<TowerActor>	g_towerPool(64);
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////TowerGame//////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////////////////////////////////////
+
+// Listener for Game events.
+void ListenForGameEvents(EventListenerPtr listener)
+{
+	safeAddListener( listener, EventType(Evt_New_Actor::gkName) );
+	safeAddListener( listener, EventType(Evt_Remove_Actor::gkName) );
+	safeAddListener( listener, EventType(Evt_New_Runner::gkName) );
+	safeAddListener( listener, EventType(Evt_New_Tower::gkName) );
+	safeAddListener( listener, EventType(Evt_Move_Actor::gkName) );
+	safeAddListener( listener, EventType(Evt_Change_GameState::gkName) );
+	safeAddListener( listener, EventType(Evt_Set_Path::gkName) );
+	safeAddListener( listener, EventType(Evt_Find_Closest_Tar::gkName) );
+	safeAddListener( listener, EventType(Evt_Shoot_Tar::gkName) );
+	safeAddListener( listener, EventType(Evt_Sell_Tower::gkName) );
+	safeAddListener( listener, EventType(Evt_Spawn_Wave::gkName) );
+	safeAddListener( listener, EventType(Evt_Change_Tower_Type::gkName) );
+	safeAddListener( listener, EventType(Evt_New_Tower_Type::gkName) );
+	safeAddListener( listener, EventType(Evt_Damage_Actor::gkName) );
+	safeAddListener( listener, EventType(Evt_Damage_Area::gkName) );
+	safeAddListener( listener, EventType(Evt_Apply_Buff::gkName) );
+	safeAddListener( listener, EventType(Evt_Create_Missile::gkName) );
+	safeAddListener( listener, EventType(Evt_Left_Click::gkName) );
+	safeAddListener( listener, EventType(Evt_Select_Tower::gkName) );
+	safeAddListener( listener, EventType(Evt_Upgrade_Selected_Tower::gkName) );
+	safeAddListener( listener, EventType(Evt_Sell_Selected_Tower::gkName) );
+}
+
+// Base constructor, adds listener.
+TowerGame::TowerGame(ResCache *resCache):m_gameMap(),m_resCache(resCache)
+{
+	g_TowerGame = this;
+
+	m_data.m_timeLeftUntilWave = 0;
+	m_data.m_waveTimeLimit = 10000;
+	m_data.m_curWave = 1;
+	m_data.m_curMoney = 6;
+	m_data.m_curLife = 10;
+	m_status = Game_Initializing;
+	m_curTowerType = -1;
+	m_selectedTower = INVALID_ACTOR_ID;
+
+	EventListenerPtr gameLogicListener (SAFE_NEW GameLogicListener( this) );
+	ListenForGameEvents(gameLogicListener);
+	m_eventListener = gameLogicListener;
+}
+
+// Clears out all actors and flushes process list.
+TowerGame::~TowerGame()
+{
+	m_actors.Clear();
+	m_runners.Clear();
+	m_projectiles.Clear();
+	m_transforms.Clear();
+
+	m_processManager.DeleteProcessList();
+
+	if (g_TowerGame == this)
+		g_TowerGame = NULL;
+}
+
+// Gets the running game.
+TowerGame *TowerGame::Get()
+{
+	return g_TowerGame;
+}
+
+// Main game loop.
+void TowerGame::OnUpdate(int deltaMS)
+{
+	// Updates all the views
+	for(GameViewList::iterator i=m_viewList.begin(); i!=m_viewList.end(); ++i)
+	{
+		(*i)->VOnUpdate( deltaMS );
+	}
+
+	switch (m_status)
+	{
+		// Main game running status, updates processes/actors, checks for win/lose condition, spawns waves
+		case Game_Running:
+			m_processManager.UpdateProcesses(deltaMS);
+			// The ground never changes, so only the other types are updated.
+			UpdateActors(AT_TOWER, deltaMS);
+			UpdateRunners(deltaMS);
+			UpdateProjectiles(deltaMS);
+			UpdateActors(AT_EFFECT, deltaMS);
+			FireTowers();
+			RemoveDeadActors();
+			m_data.m_timeLeftUntilWave -= deltaMS;
+			if (m_data.m_timeLeftUntilWave <=0)
+			{
+				safeTriggerEvent(Evt_Spawn_Wave());
+				m_data.m_timeLeftUntilWave = m_data.m_waveTimeLimit;
+			}
+			// The views decide what to do when the game is lost.
+			if (m_data.m_curLife <= 0)
+			{
+				safeTriggerEvent(Evt_Change_GameState(Game_Over));
+			}
+			break;
+		
+		// Starting a new game.
+		case Game_Initializing:
+			BuildInitialScene();
+			safeTriggerEvent(Evt_Change_GameState(Game_Running));
+			m_data.m_timeLeftUntilWave = m_data.m_waveTimeLimit;
+			break;
+
+		case Game_Pause:
+		case Game_Over:
+			break;
+	}	
+
+	// The views get this update's moves the next time they update.
+	m_transforms.Swap();
+}
+
+// Creates the basic scene for the game and sets up the tower types.
+void TowerGame::BuildInitialScene()
+{
+	if (m_luaReader.Init("test.lua") || m_luaReader.Run())
+		return; 
+	m_luaReader.ReadTowerTypes();
+	safeTriggerEvent(Evt_RebuildUI());
+	ReadMap();
+	CreateGrid();
+}
+
+// Updates every actor of one type. Actors added while it runs are updated
+// too, the same as they were when all the actors were in one map.
+void TowerGame::UpdateActors(ActorType type, int deltaMS)
+{
+	for (int i = 0; i < m_actors.Count(type); i++)
+	{
+		shared_ptr<IActor> actor = m_actors.Get(type, i);
+		actor->VOnUpdate( deltaMS );
+	}
+}
+
+// Updates the runners: their buffs first, then one pass that moves them all,
+// then whatever each one needs done after moving, in the same order the
+// runners were moved in.
+void TowerGame::UpdateRunners(int deltaMS)
+{
+	for (int i = 0; i < m_runners.Count(); i++)
+	{
+		if (!m_runners.m_buffs[i])
+			continue;
+
+		shared_ptr<Actor> runner = boost::static_pointer_cast<Actor>(m_actors.Find(m_runners.m_id[i]));
+		runner->UpdateBuffs(deltaMS);
+		m_runners.SetSpeed(i, runner->VGet()->m_speed);
+		m_runners.m_buffs[i] = runner->GetBuffMask();
+	}
+
+	m_runners.Move(deltaMS);
+
+	for (int i = 0; i < m_runners.Count(); i++)
+	{
+		ActorId id = m_runners.m_id[i];
+		switch (m_runners.m_action[i])
+		{
+			case RA_MOVED:
+			{
+				shared_ptr<IActor> runner = m_actors.Find(id);
+				runner->VGet()->m_LoopingAnim = true;
+				if (m_runners.m_facing[i] >= 0)
+					runner->VGet()->m_Direction = m_runners.m_facing[i];
+
+				// The same as VMoveActor, but the runner table already has the location.
+				Vec3 loc = m_runners.GetLocation(i);
+				Mat4x4 moveTo = Mat4x4::g_Identity;
+				moveTo.SetPosition(loc);
+				runner->VSetMat(moveTo);
+				m_gameMap.MoveActor(id, loc);
+				m_transforms.Publish(id, loc);
+				break;
+			}
+
+			// Move on to the next square of the path, or get more path once it runs out.
+			case RA_ARRIVED:
+				m_actors.Find(id)->VGet()->m_LoopingAnim = false;
+				if (!m_runners.m_path[i].Empty())
+					m_runners.m_path[i].Pop();
+
+				if (m_runners.m_path[i].Empty())
+					SetActorPath(id);
+				else
+					FollowPath(i);
+				break;
+
+			case RA_IDLE:
+				safeQueueEvent(EventPtr (SAFE_NEW Evt_Set_Path(id)));
+				break;
+		}
+	}
+}
+
+// Updates the projectiles: where their targets are now and where they're
+// headed first, a target that's gone staying where it was, then one pass
+// that moves them all, then whatever each one needs done after moving. The
+// ones that hit do their tower's damage, and they and the ones that missed
+// are taken out of the table straight away, so their slots are free for the
+// next ones fired.
+void TowerGame::UpdateProjectiles(int deltaMS)
+{
+	for (int i = 0; i < m_projectiles.Count(); i++)
+	{
+		int runner = m_runners.Find(m_projectiles.m_target[i]);
+		if (runner >= 0)
+			m_projectiles.SetTarget(i, m_runners.GetLocation(runner), m_runners.GetVelocity(runner));
+		else
+			m_projectiles.StopTarget(i);
+	}
+
+	m_projectiles.Move(deltaMS);
+
+	m_spentProjectiles.clear();
+	for (int i = 0; i < m_projectiles.Count(); i++)
+	{
+		ActorId id = m_projectiles.m_id[i];
+		switch (m_projectiles.m_action[i])
+		{
+			case PA_MOVED:
+			{
+				shared_ptr<IActor> missile = m_actors.Find(id);
+				missile->VGet()->m_LoopingAnim = true;
+				if (m_projectiles.m_facing[i] >= 0)
+					missile->VGet()->m_Direction = m_projectiles.m_facing[i];
+
+				Vec3 loc = m_projectiles.GetLocation(i);
+				Mat4x4 moveTo = Mat4x4::g_Identity;
+				moveTo.SetPosition(loc);
+				missile->VSetMat(moveTo);
+				m_transforms.Publish(id, loc);
+				break;
+			}
+
+			// The tower that fired it does the damage, if it hasn't been sold.
+			case PA_HIT:
+			{
+				m_actors.Find(id)->VGet()->m_LoopingAnim = false;
+				shared_ptr<TowerActor> tower = GetTower(m_projectiles.m_owner[i]);
+				if (tower)
+					tower->OnFire(m_projectiles.m_target[i]);
+				m_spentProjectiles.push_back(id);
+				break;
+			}
+
+			case PA_MISSED:
+				m_spentProjectiles.push_back(id);
+				break;
+		}
+	}
+
+	for (unsigned int i = 0; i < m_spentProjectiles.size(); i++)
+	{
+		m_projectiles.Remove(m_spentProjectiles[i]);
+		safeQueueEvent(EventPtr (SAFE_NEW Evt_Remove_Actor(m_spentProjectiles[i])));
+	}
+}
+
+// Adds an actor to the actor list, sends event to add actors elsewhere.
+void TowerGame::VAddActor(shared_ptr<IActor> actor)
+{
+	ActorId id = m_actors.Add(actor);
+	actor->VSetId(id);
+	if (actor->VGet()->m_Type == AT_RUNNER)
+	{
+		int timeToStart = boost::static_pointer_cast<Actor>(actor)->GetTimeToStart();
+		m_runners.Add(id, actor->VGetMat().GetPosition(), actor->VGet()->m_speed, timeToStart);
+	}
+	m_gameMap.AddActor(actor);
+	safeQueueEvent(EventPtr (SAFE_NEW Evt_New_Actor(actor)));
+
+	if (actor->VGet()->m_Type == AT_TOWER)
+	{
+		FindNewPaths();
+	}
+}
+
+// Changes the game state.
+void TowerGame::VGameStatusChange(GameStatus status)
+{
+	m_status = status;
+}
+
+// Removes an actor from the actor list.
+void TowerGame::VRemoveActor(ActorId id)
+{
+	shared_ptr<IActor> actor = m_actors.Find(id);
+	if (!actor)
+		return;
+
+	bool atEnd = m_gameMap.TestRunnerAtEnd(actor);
+
+	// If the actor is a tower, get money for it
+	if (actor->VGet()->m_Type == AT_TOWER)
+		m_data.m_curMoney += actor->VGet()->m_cost/2;
+	// If actor is not at the ending location, add the money from it.
+	else if (!atEnd)
+		m_data.m_curMoney += actor->VGet()->m_cost/2;
+	// If actor is at end, remove life from the total.
+	else
+		m_data.m_curLife--; 
+
+	m_gameMap.RemoveActor(id);
+
+	m_actors.Remove(id);
+	m_runners.Remove(id);
+	m_projectiles.Remove(id);
+
+	// Find new paths for the runners once the tower is off the map.
+	if (actor->VGet()->m_Type == AT_TOWER)
+		FindNewPaths();
+}
+
+// Moves an actor to the new location and passes the move on to the views.
+void TowerGame::VMoveActor(ActorId id, const Mat4x4 &m)
+{
+	shared_ptr<IActor> actor = m_actors.Find(id);
+	if (actor)
+	{
+		actor->VSetMat(m);
+		m_gameMap.MoveActor(id, m.GetPosition());
+		m_transforms.Publish(id, m.GetPosition());
+
+		int runner = m_runners.Find(id);
+		if (runner >= 0)
+			m_runners.SetLocation(runner, m.GetPosition());
+	}
+}
+
+// Adds a view to the view list.
+void TowerGame::VAddView(shared_ptr<IGameView> view)
+{
+	m_viewList.push_back(view);
+}
+
+// Sizes the map from map.lua. Keeps the default size if there is no map script.
+void TowerGame::ReadMap()
+{
+	int width = m_gameMap.GetWidth(), height = m_gameMap.GetHeight();
+
+	LuaMapReader reader;
+	if (reader.Init("map.lua") == S_OK && reader.Run() == S_OK)
+		reader.ReadMapSize(width, height);
+
+	m_gameMap.Init(width, height);
+}
+
+// Makes a new ActorParams from the pool.
+static shared_ptr<ActorParams> NewParams()
+{
+	return g_paramsPool.Own(POOL_NEW(g_paramsPool) ActorParams());
+}
+
+// Creates the ground actors for the map, the background and the start and end squares.
+void TowerGame::CreateGrid()
+{
+	// Base background for the map
+	shared_ptr<ActorParams> p (NewParams());
+	ActorRenderParams r;
+	r.m_Color = g_White;
+	r.m_Texture = InternString("background2.bmp");
+	p->m_Mat = Mat4x4::g_Identity;
+	r.m_Squares = m_gameMap.GetWidth();
+	r.m_Frame = 0;
+	r.m_Width = 1;
+	r.m_Height = 0.4f;
+	p->m_ActualHeight = 1.0;
+	p->m_ActualWidth = 1.0f;
+	p->m_Direction = 1;
+	r.m_NumFrames = 1;
+	r.m_NumDirections = 1;
+	r.m_hasTextureAlpha = false;
+	p->m_Type = AT_GROUND;
+	p->m_life = 2;
+	p->m_cost = 2;
+	p->m_LoopingAnim = true;
+	shared_ptr<IActor> actor (g_actorPool.Own(POOL_NEW(g_actorPool) Actor(p)));
+	actor->VSetRenderParams(r);
+	VAddActor(actor);
+
+	// A red square for the starting location.
+	p = NewParams();
+	r = ActorRenderParams();
+	r.m_Color = g_Red;
+	r.m_Texture = InternString("red.bmp");
+	p->m_Mat = m_gameMap.GetGridLocation(m_gameMap.m_start);
+	r.m_Squares = 1;
+	r.m_Frame = 0;
+	r.m_Width = 1;
+	r.m_Height = 0.4f;
+	p->m_ActualHeight = 1.0f;
+	p->m_ActualWidth = 1.0f;
+	p->m_Direction = 1;
+	r.m_NumFrames = 1;
+	r.m_NumDirections = 1;
+	r.m_hasTextureAlpha = false;
+	p->m_Type = AT_GROUND;
+	p->m_life = 2;
+	p->m_cost = 2;
+	actor = g_actorPool.Own(POOL_NEW(g_actorPool) Actor(p));
+	actor->VSetRenderParams(r);
+	VAddActor(actor);
+
+	// A blue square for the end location.
+	p = NewParams();
+	r = ActorRenderParams();
+	r.m_Color = g_Blue;
+	r.m_Texture = InternString("blue.bmp");
+	p->m_Mat = m_gameMap.GetGridLocation(m_gameMap.m_end);
+	r.m_Squares = 1;
+	r.m_Frame = 0;
+	r.m_Width = 1;
+	r.m_Height = 0.4f;
+	p->m_ActualHeight = 1.0f;
+	p->m_ActualWidth = 1.0f;
+	p->m_Direction = 1;
+	r.m_NumFrames = 1;
+	r.m_NumDirections = 1;
+	r.m_hasTextureAlpha = false;
+	p->m_Type = AT_GROUND;
+	p->m_life = 2;
+	p->m_cost = 2;
+	actor = g_actorPool.Own(POOL_NEW(g_actorPool) Actor(p));
+	actor->VSetRenderParams(r);
+	VAddActor(actor);
+}
+
+// Creates a runner and sets its location to the beginning. 
+void TowerGame::CreateRunner()
+{
+	shared_ptr<ActorParams> p (NewParams());
+	ActorRenderParams r;
+	r.m_Color = g_White;
+	r.m_Texture = InternString("skeleton.dds");
+	p->m_Mat = m_gameMap.GetGridLocation(-1);
+	r.m_Squares = 1;
+	r.m_Frame = 0;
+	r.m_Width = 1;
+	r.m_Height = 0.4f;
+	p->m_ActualHeight = 1.0f;
+	p->m_ActualWidth = 1.0f;
+	p->m_Direction = 1;
+	r.m_NumFrames = 3;
+	r.m_NumDirections = 4;
+	r.m_hasTextureAlpha = true;
+	p->m_Type = AT_RUNNER;
+	r.m_MSPerFrame = 1000 / 3;
+	p->m_LoopingAnim = false;
+	p->m_life = 5;//*(m_data.m_curWave/10);
+	p->m_cost = 2;
+	p->m_speed = 2;
+	shared_ptr<IActor> actor (g_actorPool.Own(POOL_NEW(g_actorPool) Actor(p)));
+	actor->VSetRenderParams(r);
+	VAddActor(actor);
+}
+
+// Creates a new tower at the given location.
+void TowerGame::CreateTower(Vec3 loc)
+{
+	TowerTypeMap::iterator it = m_towerMap.find(m_curTowerType);
+	if (it == m_towerMap.end())
+		return;
+	int cost = m_towerMap[m_curTowerType].m_cost;
+
+	// Checks if there is enough money for this tower type and if it will block the path to the goal.
+	if ((m_data.m_curMoney-cost >= 0) && m_gameMap.IsLocationOccupied(loc, 2, 2))
+	{
+		shared_ptr<ActorParams> p (NewParams());
+		ActorRenderParams r;
+		r.m_Color = g_White;
+		r.m_Texture = m_towerMap[m_curTowerType].m_chartexture;
+		r.m_Squares = 1;
+		r.m_Frame = 0;
+		r.m_Width = 1;
+		r.m_Height = 0.4f;
+		p->m_ActualHeight = 2;
+		p->m_ActualWidth = 2;	
+		p->m_Mat = m_gameMap.GetGridLocation(loc, p->m_ActualHeight, p->m_ActualWidth);
+		p->m_Direction = 1;
+		r.m_NumFrames = 1;
+		r.m_NumDirections = 1;
+		r.m_hasTextureAlpha = true;
+		p->m_Type = AT_TOWER;
+		r.m_MSPerFrame = 1000 / 3;
+		p->m_LoopingAnim = false;
+		p->m_life = 2;
+		p->m_cost = cost;
+		p->m_speed = 3;
+		shared_ptr<IActor> actor;
+		
+		actor = g_towerPool.Own(POOL_NEW(g_towerPool) TowerActor(m_towerMap[m_curTowerType].GetParams(), p));
+		actor->VSetRenderParams(r);
+		VAddActor(actor);
+	
+		m_data.m_curMoney -= p->m_cost;
+		
+	}
+}
+
+// Creates a missle to fire at the tower's target.
+void TowerGame::CreateMissile(ActorId id)
+{
+	shared_ptr<TowerActor> tower = GetTower(id);
+	if (!tower)
+		return;
+
+	SetTowerTarget(id);
+	ActorId tar = tower->GetTarget();
+	if (tar == INVALID_ACTOR_ID)
+		return;
+
+	// Make sure the target is a runner.
+	if (m_actors.GetType(tar) != AT_RUNNER)
+		return;
+	
+	shared_ptr<ActorParams> p (NewParams());
+	ActorRenderParams r;
+	r.m_Color = g_White;
+	r.m_Texture = InternString("red.bmp");
+	p->m_Mat = tower->VGetMat();
+	r.m_Squares = 1;
+	r.m_Frame = 0;
+	r.m_Width = 0.5;
+	r.m_Height = 0.4f;
+	p->m_ActualHeight = 0.3f;
+	p->m_ActualWidth = 0.3f;
+	p->m_Direction = 1;
+	r.m_NumFrames = 3;
+	r.m_NumDirections = 4;
+	r.m_hasTextureAlpha = true;
+	p->m_Type = AT_MISSILE;
+	r.m_MSPerFrame = 1000 / 3;
+	p->m_LoopingAnim = false;
+	p->m_life = 5;
+	p->m_cost = 0;
+	p->m_speed = 8;
+	shared_ptr<IActor> actor (g_actorPool.Own(POOL_NEW(g_actorPool) Actor(p)));
+	actor->VSetRenderParams(r);
+	VAddActor(actor);
+
+	Vec3 targetLoc = m_actors.Find(tar)->VGetMat().GetPosition();
+	m_projectiles.Add(p->m_Id, id, tar, p->m_Mat.GetPosition(), targetLoc, p->m_speed);
+}
+
+// Removes a tower
+void TowerGame::SellTower(Vec3 loc)
+{
+	ActorId id = m_gameMap.GetActorAtLoc(loc);
+	
+	if (id == INVALID_ACTOR_ID)
+		return;
+
+	if (!m_actors.Find(id))
+		return;
+
+	safeTriggerEvent(Evt_Remove_Actor(id));
+}
+
+// Sets the path to get to the goal
+void TowerGame::SetActorPath(ActorId id)
+{
+	shared_ptr<IActor> actor = m_actors.Find(id);
+	if (!actor)
+		return;
+
+	// Checks first that the actor is not at the goal, and remove if it is.
+	if (m_gameMap.TestRunnerAtEnd(actor))
+	{
+		safeQueueEvent(EventPtr (SAFE_NEW Evt_Remove_Actor(actor->VGet()->m_Id)));
+		return;
+	}
+
+	int runner = m_runners.Find(id);
+	if (runner < 0)
+		return;
+
+	m_gameMap.GetPath(actor->VGetMat().GetPosition(), m_runners.m_path[runner]);
+	FollowPath(runner);
+}
+
+// Sends the runner to the square at the front of its path, or leaves it
+// without a target if the path is empty.
+void TowerGame::FollowPath(int runner)
+{
+	m_runners.ClearTarget(runner);
+	if (!m_runners.m_path[runner].Empty())
+		m_runners.SetTarget(runner, m_gameMap.GetGridLocation(m_runners.m_path[runner].Front()).GetPosition());
+}
+
+// Gives every runner a new path from where it is, after a tower is built or
+// sold, as one batch. Every runner's path is worked out from the repaired
+// flow field first, then the results are handed out, the same as calling
+// SetActorPath on each in turn.
+void TowerGame::FindNewPaths()
+{
+	m_repathLocs.clear();
+	for (int i = 0; i < m_runners.Count(); i++)
+		m_repathLocs.push_back(m_runners.GetLocation(i));
+
+	m_gameMap.GetPaths(m_repathLocs, m_repathPaths);
+
+	for (int i = 0; i < m_runners.Count(); i++)
+	{
+		if (m_gameMap.TestRunnerAtEnd(m_repathLocs[i]))
+		{
+			safeQueueEvent(EventPtr (SAFE_NEW Evt_Remove_Actor(m_runners.m_id[i])));
+		}
+		else
+		{
+			m_runners.m_path[i] = m_repathPaths[i];
+			FollowPath(i);
+		}
+	}
+}
+
+// Changes the tower to target the closest runner.
+void TowerGame::SetTowerTarget(ActorId id)
+{
+	shared_ptr<TowerActor> tower = GetTower(id);
+	if (!tower)
+		return;
+
+	// The same reach the old search over every actor had.
+	ActorId closestId = m_gameMap.FindClosestRunner(tower->VGetMat().GetPosition(), sqrt(9999.9f));
+	if (closestId == INVALID_ACTOR_ID)
+		return;
+
+	tower->SetTarget(closestId);
+}
+
+
+// Holds a shot at the closest runner until FireTowers runs at the end of
+// the actor updates.
+void TowerGame::ShootTar(ActorId shooter, int damage)
+{
+	shared_ptr<TowerActor> tower = GetTower(shooter);
+	if (!tower)
+		return;
+
+	m_shotTowers.push_back(tower);
+	m_shotLocs.push_back(tower->VGetMat().GetPosition());
+	m_shotRanges.push_back(tower->GetRange());
+	m_shotPolicies.push_back(tower->GetTargeting());
+}
+
+// Picks a runner by each tower's targeting policy for every tower that shot
+// this tick, all at once so the map can batch them when that pays, then
+// fires the ones with a runner in range in the order they shot.
+void TowerGame::FireTowers()
+{
+	if (m_shotTowers.empty())
+		return;
+
+	m_gameMap.FindTargets(m_shotLocs, m_shotRanges, m_shotPolicies, m_shotTargets);
+
+	// Firing runs lua, so anything it shoots waits for the next tick.
+	m_firingTowers.swap(m_shotTowers);
+	m_shotTowers.clear();
+	m_shotLocs.clear();
+	m_shotRanges.clear();
+	m_shotPolicies.clear();
+
+	for (unsigned int i = 0; i < m_firingTowers.size(); i++)
+	{
+		if (m_shotTargets[i] > 0)
+			m_firingTowers[i]->OnFire(m_shotTargets[i]);
+	}
+	m_firingTowers.clear();
+}
+
+// Creates a new wave of runners
+void TowerGame::CreateWave()
+{
+	m_data.m_curWave++;
+	int spawns = WaveSpawns(m_data.m_curWave);
+	if (spawns <= 0)
+	{
+		float num = m_data.m_curWave / 5.0f;
+		spawns = ceil(num) * 3;
+	}
+
+	for (; spawns > 0; spawns--)
+	{
+		CreateRunner();
+	}
+}
+
+// Adds a new tower type to the list.
+void TowerGame::NewTowerType(TowerType p)
+{
+	p.m_type = m_towerMap.size();
+	m_towerMap[m_towerMap.size()] = p;
+}
+
+// Gets the pointer to the actor with this id.
+shared_ptr<IActor> TowerGame::GetActor(ActorId id)
+{
+	return m_actors.Find(id);
+}
+
+// Gets the tower with the id, or an empty pointer if it isn't a tower.
+shared_ptr<TowerActor> TowerGame::GetTower(ActorId id)
+{
+	if (m_actors.GetType(id) != AT_TOWER)
+		return shared_ptr<TowerActor>();
+
+	// Every actor of the tower type is a TowerActor.
+	return boost::static_pointer_cast<TowerActor>(m_actors.Find(id));
+}
+
+// Deals damage to the actor of this id. An actor this kills is removed
+// with the rest at the end of the tick.
+void TowerGame::DamageActor(ActorId id, int damage)
+{
+	if (m_actors.GetType(id) != AT_RUNNER)
+		return;
+
+	shared_ptr<IActor> actor = m_actors.Find(id);
+	if (!actor)
+		return;
+
+	bool alive = actor->VGet()->m_life >= 0;
+	if (!actor->VTakeDamage(damage) && alive)
+		m_deadActors.push_back(id);
+	m_gameMap.SetRunnerLife(id, actor->VGet()->m_life);
+}
+
+// Deals damage to every runner within the radius of the location.
+void TowerGame::DamageArea(Vec3 loc, float radius, int damage)
+{
+	m_gameMap.GetRunnersInRange(loc, radius, m_areaHits);
+	for (unsigned int i = 0; i < m_areaHits.size(); i++)
+		DamageActor(m_areaHits[i], damage);
+	m_areaHits.clear();
+}
+
+// Removes the actors killed this tick.
+void TowerGame::RemoveDeadActors()
+{
+	for (unsigned int i = 0; i < m_deadActors.size(); i++)
+		safeQueueEvent(EventPtr (SAFE_NEW Evt_Remove_Actor(m_deadActors[i])));
+	m_deadActors.clear();
+}
+
+// Applys a buff to the actor.
+void TowerGame::ApplyBuffToActor(ActorId id, shared_ptr<IBuff> buff)
+{
+	shared_ptr<IActor> actor = m_actors.Find(id);
+	if (!actor)
+		return;
+
+	actor->VApplyBuff(buff);
+
+	// Slowing a runner changes its speed, so the runner table needs it too.
+	int runner = m_runners.Find(id);
+	if (runner >= 0)
+	{
+		m_runners.SetSpeed(runner, actor->VGet()->m_speed);
+		m_runners.m_buffs[runner] = boost::static_pointer_cast<Actor>(actor)->GetBuffMask();
+	}
+}
+
+// Used when the mouse if right clicked.
+void TowerGame::RightClick(Vec3 l)
+{
+	// Check if the location is in the grid.
+	if (m_gameMap.HashLocation(l) < 0)
+	{
+		m_selectedTower = INVALID_ACTOR_ID;
+		safeQueueEvent(EventPtr (SAFE_NEW Evt_Change_Tower_Type(-1)));
+		return;
+	}
+
+	// Get the actor and select that tower at the location.
+	if (m_gameMap.GetActorAtLoc(l) != INVALID_ACTOR_ID)
+	{
+		safeQueueEvent(EventPtr (SAFE_NEW Evt_Select_Tower(m_gameMap.GetActorAtLoc(l))));
+		return;
+	}
+
+	// Create a new tower at the given location.
+	m_selectedTower = INVALID_ACTOR_ID;
+	safeQueueEvent(EventPtr (SAFE_NEW Evt_New_Tower(l)));
+}
+
+/// Sells the selected tower, if a tower is selected.
+void TowerGame::SellTower()
+{
+	if (m_selectedTower != INVALID_ACTOR_ID)
+	{
+		safeQueueEvent(EventPtr (SAFE_NEW Evt_Remove_Actor(m_selectedTower)));
+	}
+}
+
+// Upgrades the currently sellected tower with it's upgrade line.
+void TowerGame::UpgradeTower()
+{
+	shared_ptr<TowerActor> tower = GetTower(m_selectedTower);
+	if (!tower)
+		return;
+
+	TowerParams t = tower->GetTowerParams();
+
+	// Checks the tower type, it is a correct type, it isn't already at max upgrade, and the player has enough money for it.
+	if (t.m_type >= 0 && t.m_type < m_towerMap.size() && t.m_nextUpgrade<t.m_maxUpgrade &&
+		(m_data.m_curMoney-m_towerMap[t.m_type].m_upgrades[t.m_nextUpgrade].m_cost >= 0) ) 
+	{
+		tower->UpgradeTower(m_towerMap[t.m_type].m_upgrades[t.m_nextUpgrade]);
+		m_data.m_curMoney -= m_towerMap[t.m_type].m_upgrades[t.m_nextUpgrade].m_cost;
+		safeTriggerEvent(Evt_Select_Tower(m_selectedTower));
+	}
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////Actor//////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////////////////////////////////////
+
+// Default constructor.
+Actor::Actor()
+{
+	shared_ptr<ActorParams> p;
+	m_params = p;
+	m_timeToStart = rand() % 3000;
+}
+
+// Builds the actor out from the actor params.
+Actor::Actor(shared_ptr<ActorParams> p)
+{
+	m_params = p;
+	m_timeToStart = rand() % 3000;
+}
+
+// Gets how the actor is drawn, brought up to date with the game.
+const ActorRenderParams &Actor::VGetRenderParams()
+{
+	m_render.m_Id = m_params->m_Id;
+	m_render.m_Type = m_params->m_Type;
+	m_render.m_ActualWidth = m_params->m_ActualWidth;
+	m_render.m_ActualHeight = m_params->m_ActualHeight;
+	m_render.Sync(*m_params);
+	return m_render;
+}
+
+// Ticks the buffs on the actor, taking off any that have run out.
+void Actor::UpdateBuffs(int deltaMS)
+{
+	for (BuffList::iterator it = m_buffs.begin(); it != m_buffs.end();)
+	{
+		if ((*it)->VOnUpdate(deltaMS))
+		{
+			(*it)->VRemove();
+			it = m_buffs.erase(it);
+		}
+		else
+			it++;
+	}
+}
+
+// Gets a bit for each type of buff on the actor.
+unsigned int Actor::GetBuffMask()
+{
+	unsigned int mask = 0;
+	for (BuffList::iterator it = m_buffs.begin(); it != m_buffs.end(); it++)
+		mask |= 1 << (*it)->VGetType();
+
+	return mask;
+}
+
+// Updates the buffs on the actor. Runners and projectiles are moved by
+// TowerGame from their tables instead.
+void Actor::VOnUpdate(int elapsedTime)
+{
+	UpdateBuffs(elapsedTime);
+}
+
+// Will face the actor in the direction given from its current location
+void Actor::VSetDirection(Vec3 B)
+{
+	Vec3 A = m_params->m_Mat.GetPosition();
+	m_params->m_Direction = GetFacing(B.x - A.x, B.z - A.z);
+}
+
+// Gives damage to the actor and returns false if that killed it. The death
+// is only reported back, TowerGame::DamageActor adds it to m_deadActors.
+bool Actor::VTakeDamage(int damage)
+{
+	m_params->m_life -= damage;
+	if (m_params->m_life < 0)
+		return 0;
+
+	return 1;
+}
+
+// Adds a buff on the actor. Can only have 1 buff of each type going at a time.
+void Actor::VApplyBuff(shared_ptr<IBuff> buff)
+{
+	for (BuffList::iterator it = m_buffs.begin(); it != m_buffs.end(); it++)
+		if ( (*it)->VGetType() == buff->VGetType())
+			return;
+
+	m_buffs.push_back(buff);
+	buff->VApply();
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////TowerActor/////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////////////////////////////////////
+
+// Updates the tower by running the lua script for it.
+void TowerActor::VOnUpdate(int deltaMS)
+{	
+	m_luaScript.OnUpdate(deltaMS);
+}
+
+// Sets the target the tower is pointing at
+void TowerActor::SetTarget(ActorId id)
+{
+	m_curTarget = id;
+	shared_ptr<IActor> runner = TowerGame::Get()->GetActor(id);
+	if (runner)
+		VSetDirection(runner->VGetMat().GetPosition());
+	m_luaScript.SetTarget(id);
+}
+
+// Fires a shot at the current target
+void TowerActor::OnFire(ActorId id)
+{
+	shared_ptr<IActor> runner = TowerGame::Get()->GetActor(id);
+	if (runner && runner->VGet()->m_Type == AT_RUNNER)
+	{
+		m_curTarget = id;
+		VSetDirection(runner->VGetMat().GetPosition());
+		m_luaScript.Fire(m_curTarget);
+		//safeTriggerEvent(Evt_Damage_Actor(id, m_towerParams.m_damage));
+		safeTriggerEvent(Evt_Shot(VGet()->m_Id, 100, VGetMat().GetPosition(), runner->VGetMat().GetPosition(), m_towerParams.m_shottexture));
+	}
+}
+
+// Upgrades the tower with the upgrade sent
+void TowerActor::UpgradeTower(Upgrade u)
+{
+	m_towerParams.m_damage += u.m_damage;
+	m_towerParams.m_cost += u.m_cost;
+	m_towerParams.m_reloadTime += u.m_reload;
+	m_towerParams.m_range += u.m_reload;
+	m_towerParams.m_nextUpgrade++;
+	m_params->m_cost += u.m_cost;
+	m_luaScript.UpgradeTower(u);
+}
+
+// Rotates the tower to face the direction given.
+void TowerActor::VSetDirection(Vec3 B)
+{
+	Vec3 A = m_params->m_Mat.GetPosition();
+	float direction = atan2(B.z - A.z, B.x - A.x);
+	if (direction < 0)
+		direction =  2*3.1415 + direction;
+	Mat4x4 m;
+	m = Mat4x4::g_Identity;
+	m.BuildRotationY(-direction);
+	m_params->m_Mat.BuildTranslation(A);
+	m_params->m_Mat = m  * m_params->m_Mat;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////GameLogicListener//////////////////////////////////////////
+/////////////////////////////////////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////////////////////////////////////
+
+// Event listener for the game logic, mostly just calls the game's functions.
+bool GameLogicListener::HandleEvent(Event const & e)
+{
+	if (strcmp(e.getType().getName(), Evt_Remove_Actor::gkName)==0)
+	{
+		EvtData_Remove_Actor *data = e.getData<EvtData_Remove_Actor>();
+		m_game->VRemoveActor(data->m_id);
+	}
+	else
+	if (strcmp(e.getType().getName(), Evt_New_Runner::gkName)==0)
+	{
+		m_game->CreateRunner();
+	}
+	else
+	if (strcmp(e.getType().getName(), Evt_New_Tower::gkName)==0)
+	{
+		EvtData_New_Tower *data = e.getData<EvtData_New_Tower>();
+		m_game->CreateTower(data->m_pos);
+	}
+	else
+	if (strcmp(e.getType().getName(), Evt_Move_Actor::gkName)==0)
+	{
+		EvtData_Move_Actor *data = e.getData<EvtData_Move_Actor>();
+		m_game->VMoveActor(data->m_id, data->m_Mat);
+	}
+	else
+	if (strcmp(e.getType().getName(), Evt_Change_GameState::gkName)==0)
+	{
+		EvtData_Change_GameState *data = e.getData<EvtData_Change_GameState>();
+		m_game->VGameStatusChange(data->m_state);
+	}
+	else
+	if (strcmp(e.getType().getName(), Evt_Set_Path::gkName)==0)
+	{
+		EvtData_Set_Path *data = e.getData<EvtData_Set_Path>();
+		m_game->SetActorPath(data->m_id);
+	}
+	else
+	if (strcmp(e.getType().getName(), Evt_Find_Closest_Tar::gkName) == 0)
+	{
+		EvtData_Closest_Tar *data = e.getData<EvtData_Closest_Tar>();
+		m_game->SetTowerTarget(data->m_id);
+	}
+	else
+	if (strcmp(e.getType().getName(), Evt_Shoot_Tar::gkName) == 0)
+	{
+		EvtData_Shoot_Tar *data = e.getData<EvtData_Shoot_Tar>();
+		m_game->ShootTar(data->m_shooterId, data->m_damage);
+	}
+	else
+	if (strcmp(e.getType().getName(), Evt_Sell_Tower::gkName) == 0 )
+	{
+		EvtData_Sell_Tower *data = e.getData<EvtData_Sell_Tower>();
+		m_game->SellTower(data->m_pos);
+	}
+	else
+	if (strcmp(e.getType().getName(), Evt_Spawn_Wave::gkName) == 0 )
+	{
+		m_game->CreateWave();
+	}
+	else
+	if (strcmp(e.getType().getName(), Evt_Change_Tower_Type::gkName) == 0 )
+	{
+		EvtData_Change_Tower_Type *data = e.getData<EvtData_Change_Tower_Type>();
+		m_game->ChangeTowerType(data->m_type);
+	}
+	else
+	if (strcmp(e.getType().getName(), Evt_New_Tower_Type::gkName) == 0 )
+	{
+		EvtData_New_Tower_Type *data = e.getData<EvtData_New_Tower_Type>();
+		m_game->NewTowerType(data->m_params);
+	}
+	else
+	if (strcmp(e.getType().getName(), Evt_Damage_Actor::gkName) == 0 )
+	{
+		EvtData_Damage_Actor *data = e.getData<EvtData_Damage_Actor>();
+		m_game->DamageActor(data->m_id, data->m_damage);
+	}
+	else
+	if (strcmp(e.getType().getName(), Evt_Damage_Area::gkName) == 0 )
+	{
+		EvtData_Damage_Area *data = e.getData<EvtData_Damage_Area>();
+		m_game->DamageArea(data->m_loc, data->m_radius, data->m_damage);
+	}
+	else
+	if (strcmp(e.getType().getName(), Evt_Apply_Buff::gkName) == 0 )
+	{
+		EvtData_Apply_Buff *data = e.getData<EvtData_Apply_Buff>();
+		m_game->ApplyBuffToActor(data->m_buff->VGetActorId(), data->m_buff);
+	}
+	else
+	if (strcmp(e.getType().getName(), Evt_Create_Missile::gkName) == 0 )
+	{
+		EvtData_Create_Missile *data = e.getData<EvtData_Create_Missile>();
+		m_game->CreateMissile(data->m_id);
+	}
+	else
+	if (strcmp(e.getType().getName(), Evt_Left_Click::gkName) == 0 )
+	{
+		EvtData_Right_Click *data = e.getData<EvtData_Right_Click>();
+		m_game->RightClick(data->m_loc);
+	}
+	else
+	if (strcmp(e.getType().getName(), Evt_Select_Tower::gkName) == 0 )
+	{
+		EvtData_Select_Tower *data = e.getData<EvtData_Select_Tower>();
+		m_game->SelectTower(data->m_id);
+	}
+	else
+	if (strcmp(e.getType().getName(), Evt_Sell_Selected_Tower::gkName) == 0 )
+	{
+		m_game->SellTower();
+	}
+	else
+	if (strcmp(e.getType().getName(), Evt_Upgrade_Selected_Tower::gkName) == 0 )
+	{
+		m_game->UpgradeTower();
+	}
+
+	return false;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////Slow///////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////////////////////////////////////
+
+// Changes the actor's speed when applied.
+void Slow::VApply()
+{
+	shared_ptr<IActor> actor = TowerGame::Get()->GetActor(m_id);
+
+	if (actor)
+	{
+		int speed = actor->VGet()->m_speed;
+		speed = speed/2;
+		actor->VGet()->m_speed = speed;
+	}
+}
+
+// Resets the actor's speed when removed.
+void Slow::VRemove()
+{
+	shared_ptr<IActor> actor = TowerGame::Get()->GetActor(m_id);
+
+	if (actor)
+	{
+		int speed = actor->VGet()->m_speed;
+		speed = speed * 2;
+		actor->VGet()->m_speed = speed;
+	}
+}
+
+// Slowly ticks down until it is removed.
+bool Slow::VOnUpdate(int deltaMS)
+{
+	m_time -= deltaMS;
+	if (m_time <= 0)
+		return true;
+
+	return false;
+}
\ No newline at end of file
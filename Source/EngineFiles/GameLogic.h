@@ -0,0 +1,217 @@
+#pragma once
+
+#include "StdHeader.h"
+#include "Event.h"
+#include "LuaReader.h"
+#include "Process.h"
+#include "Map.h"
+#include "ActorTable.h"
+#include "RunnerTable.h"
+#include "ProjectileTable.h"
+#include "TransformStream.h"
+
+class ResCache;
+class TowerActor;
+
+// State data about the game
+struct GameData
+{
+public: 
+	int				m_timeLeftUntilWave;
+	int				m_waveTimeLimit;
+	int				m_curWave;
+	int				m_curMoney;
+	int				m_curLife;
+};
+
+// Logic class for the game.
+class TowerGame: public IGame
+{
+	friend class GameApp;
+	GameViewList		m_viewList;
+	ActorTable			m_actors;
+	RunnerTable			m_runners;
+	ProjectileTable		m_projectiles;
+	TransformStream		m_transforms;
+	GameStatus			m_status;
+	
+	EventListenerPtr	m_eventListener;
+	GameData			m_data;
+	TowerTypeMap		m_towerMap;
+	int					m_curTowerType;
+	ProcessManager		m_processManager;
+	LuaMainGame			m_luaReader;
+	ActorId				m_selectedTower;
+	ResCache			*m_resCache;
+
+	// Towers that shot this tick, waiting for FireTowers to find their targets.
+	std::vector<shared_ptr<TowerActor> >	m_shotTowers;
+	std::vector<Vec3>						m_shotLocs;
+	std::vector<float>						m_shotRanges;
+	std::vector<int>						m_shotPolicies;
+	std::vector<ActorId>					m_shotTargets;
+	std::vector<shared_ptr<TowerActor> >	m_firingTowers;
+
+	// Scratch for FindNewPaths, the runners' locations and their new paths.
+	std::vector<Vec3>						m_repathLocs;
+	std::vector<WaypointRing>				m_repathPaths;
+
+	// Actors killed this tick, and scratch for the runners an area hits.
+	std::vector<ActorId>					m_deadActors;
+	std::vector<ActorId>					m_areaHits;
+
+	// Projectiles that hit or missed this tick, taken out once they've all
+	// been looked at.
+	std::vector<ActorId>					m_spentProjectiles;
+	
+	void ReadMap();
+	void CreateGrid();
+	void FindNewPaths();
+	void FireTowers();
+	void UpdateActors(ActorType type, int deltaMS);
+	void UpdateRunners(int deltaMS);
+	void FollowPath(int runner);
+	void UpdateProjectiles(int deltaMS);
+	void RemoveDeadActors();
+	
+public:
+	Map					m_gameMap;
+
+	TowerGame(ResCache *resCache);
+	~TowerGame();
+	static TowerGame *Get();
+	void CreateWave();
+	void NewTowerType(TowerType p);
+	void CreateRunner();
+	void CreateMissile(ActorId id);
+	virtual void OnUpdate(int deltaMS);
+	virtual void VAddActor(shared_ptr<IActor> actor);
+	virtual void VRemoveActor(ActorId id);
+	virtual void VMoveActor(ActorId id, const Mat4x4 &m);
+	const TransformStream &GetTransforms() const {return m_transforms;}
+	virtual void VAddView(shared_ptr<IGameView> view);
+	void BuildInitialScene();
+	virtual void VGameStatusChange(GameStatus status);
+	void CreateTower(Vec3 loc);
+	void SetActorPath(ActorId id);
+	void SetTowerTarget(ActorId id);
+	void ShootTar(ActorId shooter, int damage);
+	void SellTower(Vec3 loc);
+	void SellTower();
+	void UpgradeTower();
+	GameData GetData() {return m_data;}
+	GameStatus GetStatus() {return m_status;}
+	ResCache *GetResCache() {return m_resCache;}
+	void ChangeTowerType(int type) {m_curTowerType = type;}
+	TowerParams GetTowerData(int type) { if (type >= 0 && type < m_towerMap.size()) return m_towerMap[type].GetParams(); else return TowerParams();}
+	int	GetNumTowerTypes() {return m_towerMap.size();}
+	int WaveSpawns(int curWave) {return m_luaReader.ReadWave(curWave); }
+	shared_ptr<IActor> GetActor(ActorId id);
+	shared_ptr<TowerActor> GetTower(ActorId id);
+	void DamageActor(ActorId id, int damage);
+	void DamageArea(Vec3 loc, float radius, int damage);
+	void ApplyBuffToActor(ActorId id, shared_ptr<IBuff> buff);
+	void RightClick(Vec3 l);
+	void SelectTower(ActorId id) {m_selectedTower = id; m_curTowerType = -1;}
+};
+
+// Base class for all the game components
+class Actor: public IActor
+{
+protected:
+	shared_ptr<ActorParams>		m_params;
+	ActorRenderParams			m_render;
+	int							m_timeToStart;
+	BuffList					m_buffs;
+public:
+	Actor();
+	Actor(shared_ptr<ActorParams> p);
+
+	virtual Mat4x4 const &VGetMat() {return m_params->m_Mat;}
+	virtual void VSetMat(const Mat4x4 &m) {m_params->m_Mat = m;}
+	virtual void VOnUpdate(int deltaMS);
+	virtual float VGetRadius() {return m_params->m_radius;}
+	virtual shared_ptr<ActorParams> VGet() {return m_params;}
+	virtual void VSetId(ActorId id) {m_params->m_Id = id;}
+	virtual void VSetParams(shared_ptr<ActorParams> p) {m_params = p;}
+	virtual const ActorRenderParams &VGetRenderParams();
+	virtual void VSetRenderParams(const ActorRenderParams &r) {m_render = r;}
+	virtual bool VTakeDamage(int damage);
+	virtual void VSetDirection(Vec3 b);
+	virtual void VApplyBuff(shared_ptr<IBuff> buff);
+	void UpdateBuffs(int deltaMS);
+	unsigned int GetBuffMask();
+	int GetTimeToStart() {return m_timeToStart;}
+};
+
+// Tower actor default class
+class TowerActor: public Actor
+{
+protected:
+	ActorId		m_curTarget;
+	TowerParams m_towerParams;
+	int			m_timeUntilNextShot;
+	LuaTower	m_luaScript;
+public:
+	TowerActor():Actor(),m_towerParams(),m_luaScript(),m_curTarget(INVALID_ACTOR_ID) {}
+	TowerActor(shared_ptr<ActorParams> p): Actor(p),m_towerParams(),m_luaScript(),m_curTarget(INVALID_ACTOR_ID) {}
+	TowerActor(TowerParams t, shared_ptr<ActorParams> p): Actor(p),m_towerParams(t),m_luaScript(p->m_Id, GetString(t.m_script)),m_curTarget(INVALID_ACTOR_ID){}
+	virtual void VOnUpdate(int deltaMS);
+	virtual void SetTarget(ActorId id); 
+	ActorId GetTarget() {return m_curTarget;}
+	float GetRange() {return m_towerParams.m_range;}
+	int GetTargeting() {return m_towerParams.m_targeting;}
+	std::string GetScript() {return GetString(m_towerParams.m_script);}
+	virtual void VSetId(ActorId id) {m_params->m_Id = id; m_luaScript.SetId(id);}
+	virtual void OnFire(ActorId id);
+	TowerParams GetTowerParams() {return m_towerParams;}
+	void UpgradeTower(Upgrade u);
+	virtual void VSetDirection(Vec3 b);
+};
+
+// Used to do visual effects
+class EffectActor : public Actor
+{
+protected:
+	float			m_size;
+public:
+	EffectActor(): Actor() {}
+	EffectActor(shared_ptr<ActorParams> p, float size) : Actor(p), m_size(size) {}
+	virtual float VGetRadius() {return m_size;}
+};
+
+// Modifies some part of the actor
+class Buff: public IBuff
+{
+protected:
+	ActorId m_id;
+	BuffType m_type;
+	int		m_time;
+
+public:
+	Buff(ActorId id, BuffType type, int time): m_id(id),m_type(type),m_time(time) {}
+	virtual void VApply() {}
+	virtual void VRemove() {}
+	virtual bool VOnUpdate(int deltaMS) { return false;}
+	virtual BuffType VGetType() {return m_type;}
+	virtual ActorId VGetActorId() {return m_id;}
+};
+
+// A buff that slows the target
+class Slow: public Buff
+{
+public:
+	Slow(ActorId id):Buff(id, BT_ICE, 1100) {}
+	virtual void VApply();
+	virtual void VRemove();
+	virtual bool VOnUpdate(int deltaMS);
+};
+
+// Event listener for the game logic
+class GameLogicListener: public IEventListener
+{
+	TowerGame * m_game;
+public:
+	GameLogicListener(TowerGame * game):m_game(game){};
+	virtual bool HandleEvent(Event const & e);
+};
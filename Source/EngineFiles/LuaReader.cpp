@@ -1,7 +1,7 @@
 #include "LuaReader.h"
 #include "Event.h"
-#include "ResourceCache\ResCache2.h"
-#include "EngineFiles\Game.h"
+#include "ResourceCache/ResCache2.h"
+#include "EngineFiles/GameLogic.h"
 
 /////////////////////////////////////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////////////////////////////////////
@@ -31,14 +31,15 @@ HRESULT LuaReader::Init(std::string file)
 		return S_FALSE;
 
 	// Gets the resource from the resource file
+	ResCache *cache = TowerGame::Get()->GetResCache();
 	Resource resource(file.c_str());
-	int size = g_App->m_ResCache->Create(resource);
+	int size = cache->Create(resource);
 
-	// Fills the character buffer with the characters from the file and puts a null at the end.
-	assert(size);
-	char *textureBuffer = (char *)g_App->m_ResCache->Get(resource);
-	std::string s (textureBuffer);
-	s[size] = '\0';
+	// Copies the characters from the file, the buffer from the cache isn't null terminated.
+	if (!size)
+		return S_FALSE;
+	char *textureBuffer = (char *)cache->Get(resource);
+	std::string s (textureBuffer, size);
 
 	// Starts lua for this class and registers the common functions.
 	L = luaL_newstate();
@@ -77,17 +78,34 @@ int LuaReader::RegisterFunctions()
 	lua_setglobal(L, "shoot_tower");
 	lua_pushcfunction(L, lua_damage_target);
 	lua_setglobal(L, "damage_target");
+	lua_pushcfunction(L, lua_damage_area);
+	lua_setglobal(L, "damage_area");
+	lua_pushcfunction(L, lua_actor_position);
+	lua_setglobal(L, "actor_position");
 	lua_pushcfunction(L, lua_slow_target);
 	lua_setglobal(L, "slow_target");
 	lua_pushcfunction(L, lua_fire_missile);
 	lua_setglobal(L, "fire_missile");
+	lua_pushnumber(L, INVALID_ACTOR_ID);
+	lua_setglobal(L, "no_target");
 	return 1;
 }
 
+// Reads an actor id from the script. Ids use all 32 bits, so they are read as
+// unsigned, and anything that can't be an id comes back as INVALID_ACTOR_ID.
+static ActorId CheckActorId(lua_State *l, int arg)
+{
+	lua_Number n = luaL_checknumber(l, arg);
+	if (!(n >= 0 && n <= (lua_Number)~(ActorId)0))
+		return INVALID_ACTOR_ID;
+
+	return (ActorId)n;
+}
+
 // Called when a tower is shooting a target
 int LuaReader::lua_shoot_tower(lua_State *l)
 {
-	int id = (int)luaL_checknumber(l, 1);
+	ActorId id = CheckActorId(l, 1);
 	int damage = (int)luaL_checknumber(l, 2);
 
 	safeTriggerEvent(Evt_Shoot_Tar(id, damage));
@@ -97,17 +115,44 @@ int LuaReader::lua_shoot_tower(lua_State *l)
 // Damages a target for a certain amount
 int LuaReader::lua_damage_target(lua_State *l)
 {
-	int id = (int) luaL_checknumber(l, 1);
+	ActorId id = CheckActorId(l, 1);
 	int damage = (int) luaL_checknumber(l, 2);
 
 	safeTriggerEvent(Evt_Damage_Actor(id, damage));
 	return 0;
 }
 
+// Damages every runner within a radius of a location on the ground.
+int LuaReader::lua_damage_area(lua_State *l)
+{
+	float x = (float) luaL_checknumber(l, 1);
+	float z = (float) luaL_checknumber(l, 2);
+	float radius = (float) luaL_checknumber(l, 3);
+	int damage = (int) luaL_checknumber(l, 4);
+
+	safeTriggerEvent(Evt_Damage_Area(Vec3(x, 0, z), radius, damage));
+	return 0;
+}
+
+// Gets the x and z of an actor on the ground, or nothing if it's gone.
+int LuaReader::lua_actor_position(lua_State *l)
+{
+	ActorId id = CheckActorId(l, 1);
+
+	shared_ptr<IActor> actor = TowerGame::Get()->GetActor(id);
+	if (!actor)
+		return 0;
+
+	Vec3 v = actor->VGetMat().GetPosition();
+	lua_pushnumber(l, v.x);
+	lua_pushnumber(l, v.z);
+	return 2;
+}
+
 // Applys the slow debuf on the given actor.
 int LuaReader::lua_slow_target(lua_State *l)
 {
-	int id = (int) luaL_checknumber(l, 1);
+	ActorId id = CheckActorId(l, 1);
 
 	shared_ptr<IBuff> buff (SAFE_NEW Slow(id));
 	safeTriggerEvent(Evt_Apply_Buff(buff));
@@ -117,7 +162,7 @@ int LuaReader::lua_slow_target(lua_State *l)
 // Fires a missle from the tower
 int LuaReader::lua_fire_missile(lua_State *l)
 {
-	int id = (int) luaL_checknumber(l, 1);
+	ActorId id = CheckActorId(l, 1);
 //	int tar = (int) luaL_checknumber(l, 2);
 
 	safeQueueEvent(EventPtr (SAFE_NEW Evt_Create_Missile(id)));
@@ -152,19 +197,63 @@ void LuaTowerReader::ReadTowerType()
 	if (lua_isnumber(L,-1))
 		p.m_cost = (int) lua_tonumber(L,-1);
 
+	// Towers shoot the closest runner unless the script picks another policy.
+	lua_getglobal(L,"targeting");
+	if (lua_isstring(L, -1))
+	{
+		std::string policy = lua_tostring(L, -1);
+		if (policy == "first")
+			p.m_targeting = TP_FIRST;
+		else
+		if (policy == "last")
+			p.m_targeting = TP_LAST;
+		else
+		if (policy == "strongest")
+			p.m_targeting = TP_STRONGEST;
+	}
+
 	lua_getglobal(L,"shottexture");
 	if (lua_isstring(L, -1))
-		p.m_shottexture = lua_tostring(L, -1);
+		p.m_shottexture = InternString(lua_tostring(L, -1));
 
 	lua_getglobal(L,"chartexture");
 	if (lua_isstring(L, -1))
-		p.m_chartexture = lua_tostring(L, -1);
+		p.m_chartexture = InternString(lua_tostring(L, -1));
 
-	p.m_script = m_file;
+	p.m_script = InternString(m_file);
 
 	safeTriggerEvent(Evt_New_Tower_Type(p)); 
 }
 
+/////////////////////////////////////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////LuaMapReader///////////////////////////////////////////////
+/////////////////////////////////////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////////////////////////////////////
+
+// Reads the width and height from the map table, leaving them alone if they aren't there.
+void LuaMapReader::ReadMapSize(int &width, int &height)
+{
+	lua_getglobal(L, "map");
+	if (!lua_istable(L, -1))
+	{
+		lua_pop(L, 1);
+		return;
+	}
+
+	lua_getfield(L, -1, "width");
+	if (lua_isnumber(L, -1))
+		width = (int) lua_tonumber(L, -1);
+	lua_pop(L, 1);
+
+	lua_getfield(L, -1, "height");
+	if (lua_isnumber(L, -1))
+		height = (int) lua_tonumber(L, -1);
+	lua_pop(L, 1);
+
+	lua_pop(L, 1);
+}
+
 /////////////////////////////////////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////////////////////////////////////
 //////////////////////////////////LuaMainGame////////////////////////////////////////////////
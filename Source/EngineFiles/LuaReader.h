@@ -16,6 +16,8 @@ protected:
 	int RegisterFunctions();
 	static int lua_shoot_tower(lua_State *l);
 	static int lua_damage_target(lua_State *l);
+	static int lua_damage_area(lua_State *l);
+	static int lua_actor_position(lua_State *l);
 	static int lua_slow_target(lua_State *l);
 	static int lua_fire_missile(lua_State *l);
 public:
@@ -43,6 +45,13 @@ public:
 	void ReadTowerType();
 };
 
+// Lua reader for the map script.
+class LuaMapReader: public LuaReader
+{
+public:
+	void ReadMapSize(int &width, int &height);
+};
+
 // Lua reader for the tower scripts.
 class LuaTower: public LuaReader
 {
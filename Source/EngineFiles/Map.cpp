@@ -0,0 +1,1856 @@
+/*
+The map grid the game is played on. Keeps track of which squares are taken by
+towers and finds the paths the runners take from the start to the end.
+*/
+
+#include "StdHeader.h"
+#include "Map.h"
+#include <float.h>
+
+// The targeting kernel uses SSE2 where the compiler targets it.
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define MAP_SSE2
+#include <emmintrin.h>
+#endif
+
+// Goal distance of a square that can't reach the end.
+static const int kNoPath = 0x3fffffff;
+
+// Steps to the squares right, up, left and down of a square.
+static const int kStepX[4] = {1, 0, -1, 0};
+static const int kStepY[4] = {0, 1, 0, -1};
+
+// How many times cheaper a runner is to rank in the packed arrays than in a
+// square's list, roughly, from targetbench. See Map::ShouldPackTargets.
+static const double kPackGain = 50;
+
+// Keeps the runner if its score is lower than the best so far, for
+// distances or policy keys alike. Ties go to the lowest id.
+static inline void KeepBest(float score, ActorId id, ActorId &best, float &bestScore)
+{
+	if (score < bestScore || (score == bestScore && (best == INVALID_ACTOR_ID || id < best)))
+	{
+		best = id;
+		bestScore = score;
+	}
+}
+
+// Scores a runner the way a targeting policy ranks them, lowest first. Its
+// progress is how far it still has to go, see Map::GetRunnerProgress, and
+// runners that can't reach the end count as furthest back whichever end of
+// the path a policy wants.
+static inline float PolicyKey(int policy, float progress, float life)
+{
+	if (policy == TP_FIRST)
+		return progress;
+	if (policy == TP_LAST)
+		return progress < (float)kNoPath ? -progress : (float)kNoPath;
+	return -life;
+}
+
+// Finds the closest of the packed runners from begin to end, four at a time
+// where SSE2 is there. Only a group of four with one as close as the best
+// so far is looked at one by one, which is rare once a close one is found.
+static void ClosestInSpan(const float *xs, const float *zs, const ActorId *ids, int begin, int end,
+						  float x, float z, ActorId &best, float &bestSq)
+{
+	int i = begin;
+#ifdef MAP_SSE2
+	__m128 vx = _mm_set1_ps(x);
+	__m128 vz = _mm_set1_ps(z);
+	for (; i + 4 <= end; i += 4)
+	{
+		__m128 dx = _mm_sub_ps(_mm_loadu_ps(xs + i), vx);
+		__m128 dz = _mm_sub_ps(_mm_loadu_ps(zs + i), vz);
+		__m128 sq = _mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dz, dz));
+		int mask = _mm_movemask_ps(_mm_cmple_ps(sq, _mm_set1_ps(bestSq)));
+		if (mask)
+		{
+			float lanes[4];
+			_mm_storeu_ps(lanes, sq);
+			for (int k = 0; k < 4; k++)
+				if (mask & (1 << k))
+					KeepBest(lanes[k], ids[i + k], best, bestSq);
+		}
+	}
+#endif
+	for (; i < end; i++)
+	{
+		float dx = xs[i] - x;
+		float dz = zs[i] - z;
+		KeepBest(dx * dx + dz * dz, ids[i], best, bestSq);
+	}
+}
+
+// Finds the packed runner from begin to end within range that has the
+// lowest key, four at a time where SSE2 is there.
+static void BestInSpan(const float *xs, const float *zs, const float *keys, const ActorId *ids, int begin, int end,
+					   float x, float z, float rangeSq, ActorId &best, float &bestKey)
+{
+	int i = begin;
+#ifdef MAP_SSE2
+	__m128 vx = _mm_set1_ps(x);
+	__m128 vz = _mm_set1_ps(z);
+	__m128 vr = _mm_set1_ps(rangeSq);
+	for (; i + 4 <= end; i += 4)
+	{
+		__m128 dx = _mm_sub_ps(_mm_loadu_ps(xs + i), vx);
+		__m128 dz = _mm_sub_ps(_mm_loadu_ps(zs + i), vz);
+		__m128 sq = _mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dz, dz));
+		__m128 better = _mm_cmple_ps(_mm_loadu_ps(keys + i), _mm_set1_ps(bestKey));
+		int mask = _mm_movemask_ps(_mm_and_ps(_mm_cmple_ps(sq, vr), better));
+		for (int k = 0; mask && k < 4; k++)
+			if (mask & (1 << k))
+				KeepBest(keys[i + k], ids[i + k], best, bestKey);
+	}
+#endif
+	for (; i < end; i++)
+	{
+		float dx = xs[i] - x;
+		float dz = zs[i] - z;
+		if (dx * dx + dz * dz <= rangeSq)
+			KeepBest(keys[i], ids[i], best, bestKey);
+	}
+}
+
+// Halves of the map's edge, split by the start and end squares. The upper
+// half runs over the rows above them and the lower half under them.
+enum
+{
+	SIDE_UPPER = 1,
+	SIDE_LOWER = 2,
+	SIDE_BOTH = SIDE_UPPER | SIDE_LOWER
+};
+
+// Spreads the set bits of r towards the high bits, through the set bits of open.
+static inline MapWord FillHigh(MapWord r, MapWord open)
+{
+	r |= open & (r << 1);	open &= open << 1;
+	r |= open & (r << 2);	open &= open << 2;
+	r |= open & (r << 4);	open &= open << 4;
+	r |= open & (r << 8);	open &= open << 8;
+	r |= open & (r << 16);	open &= open << 16;
+	r |= open & (r << 32);
+	return r;
+}
+
+// Spreads the set bits of r towards the low bits, through the set bits of open.
+static inline MapWord FillLow(MapWord r, MapWord open)
+{
+	r |= open & (r >> 1);	open &= open >> 1;
+	r |= open & (r >> 2);	open &= open >> 2;
+	r |= open & (r >> 4);	open &= open >> 4;
+	r |= open & (r >> 8);	open &= open >> 8;
+	r |= open & (r >> 16);	open &= open >> 16;
+	r |= open & (r >> 32);
+	return r;
+}
+
+// Spreads the reached squares in word k of a row along the open squares next
+// to them, carrying into the words either side for as long as the run goes on.
+static void FillWord(MapWord *reached, const MapWord *open, int words, int k)
+{
+	const MapWord top = (MapWord)1 << (MAP_WORD_BITS - 1);
+	reached[k] = FillLow(FillHigh(reached[k], open[k]), open[k]);
+
+	for (int i = k + 1; i < words && (reached[i-1] & top) && (open[i] & 1) && !(reached[i] & 1); i++)
+		reached[i] = FillHigh(reached[i] | 1, open[i]);
+
+	for (int i = k - 1; i >= 0 && (reached[i+1] & 1) && (open[i] & top) && !(reached[i] & top); i--)
+		reached[i] = FillLow(reached[i] | top, open[i]);
+}
+
+// Takes the open squares next to the reached ones in the row beside this one,
+// then spreads them along the row. Returns true if the row reached anything new.
+static bool PullRow(MapWord *reached, const MapWord *beside, const MapWord *open, int words)
+{
+	bool grew = false;
+	for (int k = 0; k < words; k++)
+	{
+		MapWord add = beside[k] & open[k] & ~reached[k];
+		if (add)
+		{
+			reached[k] |= add;
+			FillWord(reached, open, words, k);
+			grew = true;
+		}
+	}
+
+	return grew;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////Map////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////////////////////////////////////
+
+// Default constructor 
+Map::Map(int width, int height):m_searchId(0), m_lastRepairCount(0), m_placeableDirty(true)
+{
+	Init(width, height);
+}
+
+// Sets up an empty map of the given size. The start square is on the left
+// edge half way up, and the end square is across from it on the right edge.
+void Map::Init(int width, int height)
+{
+	m_width = max(2, min(width, MAX_MAP_SIZE));
+	m_height = max(2, min(height, MAX_MAP_SIZE));
+	m_cells = m_width * m_height;
+	m_start = m_width * (m_height / 2);
+	m_end = m_start + m_width - 1;
+
+	m_grid.Init(m_cells, INVALID_ACTOR_ID);
+	m_cellFlags.Init(m_cells, 0);
+	m_footprints.clear();
+	m_runners.clear();
+	m_freeRunners.clear();
+	m_runnerHead.Init(m_cells, -1);
+	m_offMapHead = -1;
+	m_packOffMap = 0;
+
+	// Towers can't go on the start or end squares.
+	m_cellFlags.Set(m_start, CELL_RESERVED);
+	m_cellFlags.Set(m_end, CELL_RESERVED);
+
+	m_openList.Init(m_cells);
+	m_G.Init(m_cells, 0);
+	m_parent.Init(m_cells, -1);
+	m_seen.Init(m_cells, 0);
+	m_closed.Init(m_cells, 0);
+	m_searchId = 0;
+
+	m_goalDistance.Init(m_cells, kNoPath);
+	m_rhs.Init(m_cells, kNoPath);
+	m_fieldQueue.Init(m_cells);
+	m_lastRepairCount = 0;
+
+	// Every square starts open, the bits past the right edge stay clear.
+	m_rowWords = (m_width + MAP_WORD_BITS - 1) / MAP_WORD_BITS;
+	m_open.assign(m_height * m_rowWords, 0);
+	m_reached.assign(m_height * m_rowWords, 0);
+	for (int i = 0; i < m_cells; i++)
+		SetOpen(i, true);
+
+	m_clustersX = (m_width + CLUSTER_SIZE - 1) / CLUSTER_SIZE;
+	m_clustersY = (m_height + CLUSTER_SIZE - 1) / CLUSTER_SIZE;
+	m_clusters.clear();
+	m_dirtyClusters.clear();
+	m_clusterDist.assign(CLUSTER_SIZE * CLUSTER_SIZE, kNoPath);
+
+	m_placeable.assign(m_height * m_rowWords, 0);
+	m_blockGroup.Init(m_cells, -1);
+	m_groupSides.clear();
+	m_placeableDirty = true;
+
+	// Seeds the flow field, it gets filled in the first time it is used.
+	m_changedCells.clear();
+	m_changedCells.push_back(m_end);
+}
+
+// Fills out with the squares up, down, left and right of the cell that are on the map.
+// Returns how many there are.
+int Map::GetNeighbours(int cell, int *out)
+{
+	int x = cell % m_width;
+	int y = cell / m_width;
+	int count = 0;
+
+	if (x + 1 < m_width)
+		out[count++] = cell + 1;
+	if (y + 1 < m_height)
+		out[count++] = cell + m_width;
+	if (x > 0)
+		out[count++] = cell - 1;
+	if (y > 0)
+		out[count++] = cell - m_width;
+
+	return count;
+}
+
+// Puts the id in the grid square, remembering squares that become taken or
+// free so the flow field can be repaired around them.
+void Map::SetCell(int cell, ActorId id)
+{
+	if ((m_grid.Get(cell) == INVALID_ACTOR_ID) != (id == INVALID_ACTOR_ID))
+	{
+		m_changedCells.push_back(cell);
+		m_placeableDirty = true;
+		DirtyClusters(cell);
+	}
+	m_grid.Set(cell, id);
+	SetOpen(cell, id == INVALID_ACTOR_ID);
+}
+
+// Sets or clears the square's bit in the walkability bitset.
+void Map::SetOpen(int cell, bool open)
+{
+	if (open)
+		m_open[GetBitWord(cell)] |= GetBitMask(cell);
+	else
+		m_open[GetBitWord(cell)] &= ~GetBitMask(cell);
+}
+
+// Checks the square's bit in the walkability bitset.
+bool Map::IsOpen(int cell) const
+{
+	return (m_open[GetBitWord(cell)] & GetBitMask(cell)) != 0;
+}
+
+// Puts the actor on the map and keeps its footprint. Towers take the squares
+// under them, runners are hashed by the square they're in. Returns true if
+// a tower took its squares.
+bool Map::AddActor(shared_ptr<IActor> actor)
+{
+	ActorId id = actor->VGet()->m_Id;
+	Vec3 loc = actor->VGetMat().GetPosition();
+
+	if (actor->VGet()->m_Type == AT_TOWER)
+	{
+		// The tower sits in the middle of its footprint, so its position
+		// hashes to the highest square of it.
+		int width = (int)actor->VGet()->m_ActualWidth;
+		int height = (int)actor->VGet()->m_ActualHeight;
+		int	mapPlace = HashLocation(loc);
+		if (mapPlace < 0 || mapPlace % m_width < width-1 || mapPlace / m_width < height-1)
+			return false;
+
+		MapFootprint footprint(AT_TOWER, mapPlace - m_width*(height-1) - (width-1), width, height);
+		for (int i = 0; i < height; i++)
+			for (int j = 0; j < width; j++)
+				SetCell(footprint.m_corner + m_width*i + j, id);
+		m_footprints[id] = footprint;
+		return true;
+	}
+	else
+	if (actor->VGet()->m_Type == AT_RUNNER)
+		AddRunner(id, loc, actor->VGet()->m_life);
+	
+	return false;
+}
+
+// Puts a runner in the spatial hash, in the list of the square it's in.
+// The life is what the runner is ranked by when towers target the strongest.
+void Map::AddRunner(ActorId id, Vec3 loc, float life)
+{
+	MapFootprint footprint(AT_RUNNER);
+	if (m_freeRunners.empty())
+	{
+		footprint.m_slot = m_runners.size();
+		m_runners.push_back(MapRunner());
+	}
+	else
+	{
+		footprint.m_slot = m_freeRunners.back();
+		m_freeRunners.pop_back();
+	}
+
+	MapRunner &runner = m_runners[footprint.m_slot];
+	runner.m_id = id;
+	runner.m_x = loc.x;
+	runner.m_z = loc.z;
+	runner.m_life = life;
+	LinkRunner(footprint.m_slot, -1);
+	SetRunnerCell(footprint, HashLocation(loc));
+	m_footprints[id] = footprint;
+}
+
+// Puts the runner at the front of the square's list, or the off map list for -1.
+void Map::LinkRunner(int slot, int cell)
+{
+	int head = cell >= 0 ? m_runnerHead.Get(cell) : m_offMapHead;
+	m_runners[slot].m_prev = -1;
+	m_runners[slot].m_next = head;
+	if (head >= 0)
+		m_runners[head].m_prev = slot;
+
+	if (cell >= 0)
+		m_runnerHead.Set(cell, slot);
+	else
+		m_offMapHead = slot;
+}
+
+// Takes the runner out of the square's list, or the off map list for -1.
+void Map::UnlinkRunner(int slot, int cell)
+{
+	MapRunner &runner = m_runners[slot];
+	if (runner.m_next >= 0)
+		m_runners[runner.m_next].m_prev = runner.m_prev;
+
+	if (runner.m_prev >= 0)
+		m_runners[runner.m_prev].m_next = runner.m_next;
+	else
+	if (cell >= 0)
+		m_runnerHead.Set(cell, runner.m_next);
+	else
+		m_offMapHead = runner.m_next;
+}
+
+// Moves a runner's hash entry to the square it is now in.
+void Map::SetRunnerCell(MapFootprint &footprint, int cell)
+{
+	if (footprint.m_corner == cell)
+		return;
+
+	UnlinkRunner(footprint.m_slot, footprint.m_corner);
+	LinkRunner(footprint.m_slot, cell);
+	footprint.m_corner = cell;
+}
+
+// Keeps the runner positions and hash lists up to date as runners move.
+void Map::MoveActor(ActorId id, Vec3 v)
+{
+	FootprintMap::iterator it = m_footprints.find(id);
+	if (it == m_footprints.end() || (*it).second.m_type != AT_RUNNER)
+		return;
+
+	MapRunner &runner = m_runners[(*it).second.m_slot];
+	runner.m_x = v.x;
+	runner.m_z = v.z;
+	SetRunnerCell((*it).second, HashLocation(v));
+}
+
+// Walks a list of runners starting at the slot, keeping the closest one to
+// the location on the ground.
+void Map::CheckRunners(int slot, Vec3 v, ActorId &best, float &bestSq)
+{
+	for (; slot >= 0; slot = m_runners[slot].m_next)
+	{
+		const MapRunner &runner = m_runners[slot];
+		float dx = runner.m_x - v.x;
+		float dz = runner.m_z - v.z;
+		KeepBest(dx * dx + dz * dz, runner.m_id, best, bestSq);
+	}
+}
+
+// Finds the runner closest to the location on the ground, no further away
+// than range, INVALID_ACTOR_ID if there isn't one. The squares are looked at in rings
+// going out from the location, stopping once a ring is too far away to hold
+// anything closer than the best so far.
+ActorId Map::FindClosestRunner(Vec3 v, float range)
+{
+	ActorId best = INVALID_ACTOR_ID;
+	float bestSq = range * range;
+	CheckRunners(m_offMapHead, v, best, bestSq);
+
+	int cx = (int)floor(v.x) + m_width/2;
+	int cy = (int)floor(v.z) + m_height/2;
+	int rings = max(max(abs(cx), abs(m_width - 1 - cx)), max(abs(cy), abs(m_height - 1 - cy)));
+
+	for (int k = 0; k <= rings; k++)
+	{
+		// Every square in ring k is at least k-1 from the location.
+		if (k > 1 && (float)(k - 1) * (k - 1) > bestSq)
+			break;
+
+		for (int y = max(0, cy - k); y <= min(m_height - 1, cy + k); y++)
+		{
+			// Only the two ends of a row that isn't the ring's top or bottom.
+			int step = (y == cy - k || y == cy + k) ? 1 : 2 * k;
+			for (int x = cx - k; x <= cx + k; x += max(1, step))
+			{
+				if (x >= 0 && x < m_width)
+					CheckRunners(m_runnerHead.Get(x + y * m_width), v, best, bestSq);
+			}
+		}
+	}
+
+	return best;
+}
+
+// Packs every runner's position into the arrays the batched searches read.
+// Walking the squares in order leaves the runners sorted by square. With
+// keys, the scores the targeting policies rank runners by are packed too,
+// along with the best runner in each square for each policy.
+void Map::PackRunners(bool withKeys)
+{
+	m_packX.clear();
+	m_packZ.clear();
+	m_packId.clear();
+	m_packCell.clear();
+	m_packSquares.clear();
+	m_packSquareStart.clear();
+	for (int p = 0; p < TP_COUNT; p++)
+	{
+		m_packKeys[p].clear();
+		m_squareKeys[p].clear();
+		m_squareIds[p].clear();
+	}
+
+	for (int slot = m_offMapHead; slot >= 0; slot = m_runners[slot].m_next)
+		PackRunner(slot, -1, -1, withKeys);
+	m_packOffMap = m_packId.size();
+
+	if (withKeys)
+		UpdateFlowField();
+
+	for (int c = 0; c < m_runnerHead.GetChunkCount(); c++)
+	{
+		if (!m_runnerHead.HasChunk(c))
+			continue;
+
+		int last = min(m_cells, (c + 1) * ChunkedGrid<int>::CHUNK_SIZE);
+		for (int i = c * ChunkedGrid<int>::CHUNK_SIZE; i < last; i++)
+		{
+			int slot = m_runnerHead.Get(i);
+			if (slot < 0)
+				continue;
+
+			int start = m_packId.size();
+			int next = withKeys ? GetNextStep(i) : -1;
+			for (; slot >= 0; slot = m_runners[slot].m_next)
+				PackRunner(slot, i, next, withKeys);
+
+			if (withKeys)
+				PackSquare(i, start);
+		}
+	}
+	m_packSquareStart.push_back(m_packId.size());
+}
+
+// Adds a runner to the packed arrays, with its key for each policy that
+// ranks runners by something other than how close they are. Next is the
+// square after the runner's own on its way to the end.
+void Map::PackRunner(int slot, int cell, int next, bool withKeys)
+{
+	const MapRunner &runner = m_runners[slot];
+	m_packX.push_back(runner.m_x);
+	m_packZ.push_back(runner.m_z);
+	m_packId.push_back(runner.m_id);
+	m_packCell.push_back(cell);
+
+	if (withKeys)
+	{
+		float progress = GetRunnerProgress(cell, next, runner.m_x, runner.m_z);
+		for (int p = TP_FIRST; p < TP_COUNT; p++)
+			m_packKeys[p].push_back(PolicyKey(p, progress, runner.m_life));
+	}
+}
+
+// Records a square with runners in it, packed from start on, and which of
+// them each policy ranks best.
+void Map::PackSquare(int cell, int start)
+{
+	m_packSquares.push_back(cell);
+	m_packSquareStart.push_back(start);
+
+	for (int p = TP_FIRST; p < TP_COUNT; p++)
+	{
+		ActorId best = INVALID_ACTOR_ID;
+		float bestKey = FLT_MAX;
+		for (unsigned int i = start; i < m_packId.size(); i++)
+			KeepBest(m_packKeys[p][i], m_packId[i], best, bestKey);
+		m_squareKeys[p].push_back(bestKey);
+		m_squareIds[p].push_back(best);
+	}
+}
+
+// Finds the squares in a row that are within reach of the location, from
+// first to last. Returns false if none of the row could be.
+bool Map::GetRowReach(int y, Vec3 v, float reachSq, int &first, int &last)
+{
+	first = 0;
+	last = -1;
+	float top = (float)(y - m_height/2);
+	float dz = max(0.0f, max(top - v.z, v.z - (top + 1)));
+	if (dz * dz > reachSq)
+		return false;
+	if (y < 0 || y >= m_height)
+		return true;
+
+	// A little extra reach so rounding never drops a tie at the edge.
+	float reach = sqrt(reachSq - dz * dz) + 0.001f;
+	first = max(0, (int)floor(v.x - reach) + m_width/2) + y * m_width;
+	last = min(m_width - 1, (int)floor(v.x + reach) + m_width/2) + y * m_width;
+	return true;
+}
+
+// Finds the closest packed runner within range. Rows are checked working out
+// from the location's own, each narrowed to the part closer than the best
+// runner found so far.
+ActorId Map::ClosestPacked(Vec3 v, float range)
+{
+	ActorId best = INVALID_ACTOR_ID;
+	float bestSq = range * range;
+	const float *xs = &m_packX[0];
+	const float *zs = &m_packZ[0];
+	const ActorId *ids = &m_packId[0];
+	const int *cells = &m_packCell[0];
+	const int *cellsEnd = cells + m_packCell.size();
+
+	int row = (int)floor(v.z) + m_height/2;
+	bool above = true, below = true;
+	for (int d = 0; above || below; d++)
+	{
+		for (int side = 0; side < 2; side++)
+		{
+			bool &more = side ? below : above;
+			int first, last;
+			if (!more || (d == 0 && side))
+				continue;
+
+			more = GetRowReach(side ? row + d : row - d, v, bestSq, first, last);
+			if (first > last)
+				continue;
+
+			int begin = std::lower_bound(cells + m_packOffMap, cellsEnd, first) - cells;
+			int end = std::lower_bound(cells + begin, cellsEnd, last + 1) - cells;
+			ClosestInSpan(xs, zs, ids, begin, end, v.x, v.z, best, bestSq);
+		}
+		if (d == 0)
+			below = above;
+	}
+
+	// The off the map runners go last, when the best so far rules most out.
+	ClosestInSpan(xs, zs, ids, 0, m_packOffMap, v.x, v.z, best, bestSq);
+	return best;
+}
+
+// Finds the packed runner within range with the lowest key for the policy.
+// The squares wholly in range are settled first by their best runners alone.
+// Then the squares cut by the edge of the range are searched, skipping any
+// whose best runner couldn't beat the best so far anyway.
+ActorId Map::BestPacked(Vec3 v, float range, int policy)
+{
+	ActorId best = INVALID_ACTOR_ID;
+	float bestKey = FLT_MAX;
+	float rangeSq = range * range;
+	const float *xs = &m_packX[0];
+	const float *zs = &m_packZ[0];
+	const float *keys = &m_packKeys[policy][0];
+	const ActorId *ids = &m_packId[0];
+	if (m_packSquares.empty())
+	{
+		BestInSpan(xs, zs, keys, ids, 0, m_packOffMap, v.x, v.z, rangeSq, best, bestKey);
+		return best;
+	}
+
+	const int *squares = &m_packSquares[0];
+	const int *squaresEnd = squares + m_packSquares.size();
+	const float *squareKeys = &m_squareKeys[policy][0];
+	const ActorId *squareIds = &m_squareIds[policy][0];
+	m_edgeSquares.clear();
+
+	int y0 = max(0, (int)floor(v.z - range) + m_height/2);
+	int y1 = min(m_height - 1, (int)floor(v.z + range) + m_height/2);
+	for (int y = y0; y <= y1; y++)
+	{
+		int first, last;
+		if (!GetRowReach(y, v, rangeSq, first, last) || first > last)
+			continue;
+
+		float top = (float)(y - m_height/2);
+		float dz = max(fabs(top - v.z), fabs(top + 1 - v.z));
+		for (const int *i = std::lower_bound(squares, squaresEnd, first); i != squaresEnd && *i <= last; i++)
+		{
+			float left = (float)(*i % m_width - m_width/2);
+			float dx = max(fabs(left - v.x), fabs(left + 1 - v.x));
+			if (dx * dx + dz * dz + 0.001f < rangeSq)
+				KeepBest(squareKeys[i - squares], squareIds[i - squares], best, bestKey);
+			else
+				m_edgeSquares.push_back(i - squares);
+		}
+	}
+
+	for (unsigned int e = 0; e < m_edgeSquares.size(); e++)
+	{
+		int i = m_edgeSquares[e];
+		if (squareKeys[i] > bestKey || (squareKeys[i] == bestKey && squareIds[i] > best))
+			continue;
+
+		BestInSpan(xs, zs, keys, ids, m_packSquareStart[i], m_packSquareStart[i + 1], v.x, v.z, rangeSq, best, bestKey);
+	}
+
+	BestInSpan(xs, zs, keys, ids, 0, m_packOffMap, v.x, v.z, rangeSq, best, bestKey);
+	return best;
+}
+
+// Finds the closest runner within range of each location, the same answers
+// FindClosestRunner gives one at a time. The runners are packed once for the
+// whole batch.
+void Map::FindClosestRunners(const std::vector<Vec3> &locs, const std::vector<float> &ranges, std::vector<ActorId> &targets)
+{
+	PackRunners(false);
+	targets.resize(locs.size());
+	for (unsigned int q = 0; q < locs.size(); q++)
+		targets[q] = m_packId.empty() ? INVALID_ACTOR_ID : ClosestPacked(locs[q], ranges[q]);
+}
+
+// Walks a list of runners starting at the slot, all in the cell, keeping
+// the one within range with the lowest key for the policy. Next is the
+// square after the cell on the way to the end.
+void Map::RankRunners(int slot, int cell, int next, Vec3 v, float rangeSq, int policy, ActorId &best, float &bestKey)
+{
+	for (; slot >= 0; slot = m_runners[slot].m_next)
+	{
+		const MapRunner &runner = m_runners[slot];
+		float dx = runner.m_x - v.x;
+		float dz = runner.m_z - v.z;
+		if (dx * dx + dz * dz <= rangeSq)
+		{
+			float progress = GetRunnerProgress(cell, next, runner.m_x, runner.m_z);
+			KeepBest(PolicyKey(policy, progress, runner.m_life), runner.m_id, best, bestKey);
+		}
+	}
+}
+
+// Picks the runner within range of the location the policy ranks best, the
+// same answer FindTargets gives, by walking the squares in range.
+ActorId Map::FindBestRunner(Vec3 v, float range, int policy)
+{
+	if (policy <= TP_CLOSEST || policy >= TP_COUNT)
+		return FindClosestRunner(v, range);
+
+	UpdateFlowField();
+	ActorId best = INVALID_ACTOR_ID;
+	float bestKey = FLT_MAX;
+	float rangeSq = range * range;
+	RankRunners(m_offMapHead, -1, -1, v, rangeSq, policy, best, bestKey);
+
+	int y0 = max(0, (int)floor(v.z - range) + m_height/2);
+	int y1 = min(m_height - 1, (int)floor(v.z + range) + m_height/2);
+	for (int y = y0; y <= y1; y++)
+	{
+		int first, last;
+		if (!GetRowReach(y, v, rangeSq, first, last))
+			continue;
+
+		for (int cell = first; cell <= last; cell++)
+		{
+			int slot = m_runnerHead.Get(cell);
+			if (slot >= 0)
+				RankRunners(slot, cell, GetNextStep(cell), v, rangeSq, policy, best, bestKey);
+		}
+	}
+
+	return best;
+}
+
+// Checks whether packing the runners pays for itself over searching the
+// squares around each location. Packing costs about one step for every
+// runner and every square, and saves some for every runner each shot looks
+// at, which grows with the runners a square. So a big sparse map never
+// packs, and a crowded one does once a few towers shoot.
+bool Map::ShouldPackTargets(int shots)
+{
+	double runners = (double)(m_runners.size() - m_freeRunners.size());
+	return shots * kPackGain * runners >= (double)m_cells * (runners + m_cells);
+}
+
+// Picks a runner within range of each location by that location's policy:
+// the closest, the one furthest along the path, the one furthest back, or
+// the one with the most life. Ties go to the lowest id. The runners are only
+// packed when there are enough shots to pay for it.
+void Map::FindTargets(const std::vector<Vec3> &locs, const std::vector<float> &ranges, const std::vector<int> &policies,
+					  std::vector<ActorId> &targets)
+{
+	targets.resize(locs.size());
+	if (!ShouldPackTargets(locs.size()))
+	{
+		for (unsigned int q = 0; q < locs.size(); q++)
+			targets[q] = FindBestRunner(locs[q], ranges[q], policies[q]);
+		return;
+	}
+
+	PackRunners(true);
+	for (unsigned int q = 0; q < locs.size(); q++)
+	{
+		int policy = policies[q];
+		if (m_packId.empty())
+			targets[q] = INVALID_ACTOR_ID;
+		else
+		if (policy <= TP_CLOSEST || policy >= TP_COUNT)
+			targets[q] = ClosestPacked(locs[q], ranges[q]);
+		else
+			targets[q] = BestPacked(locs[q], ranges[q], policy);
+	}
+}
+
+// Sets the life a runner is ranked by when targeting the strongest.
+void Map::SetRunnerLife(ActorId id, float life)
+{
+	FootprintMap::iterator it = m_footprints.find(id);
+	if (it != m_footprints.end() && (*it).second.m_type == AT_RUNNER)
+		m_runners[(*it).second.m_slot].m_life = life;
+}
+
+// Adds the runners in a list starting at the slot that are within range of the location.
+void Map::AddRunnersInRange(int slot, Vec3 v, float rangeSq, std::vector<ActorId> &ids)
+{
+	for (; slot >= 0; slot = m_runners[slot].m_next)
+	{
+		float dx = m_runners[slot].m_x - v.x;
+		float dz = m_runners[slot].m_z - v.z;
+		if (dx * dx + dz * dz <= rangeSq)
+			ids.push_back(m_runners[slot].m_id);
+	}
+}
+
+// Fills ids with every runner no further than range from the location on the ground.
+void Map::GetRunnersInRange(Vec3 v, float range, std::vector<ActorId> &ids)
+{
+	ids.clear();
+	AddRunnersInRange(m_offMapHead, v, range * range, ids);
+
+	int x0 = max(0, (int)floor(v.x - range) + m_width/2);
+	int x1 = min(m_width - 1, (int)floor(v.x + range) + m_width/2);
+	int y0 = max(0, (int)floor(v.z - range) + m_height/2);
+	int y1 = min(m_height - 1, (int)floor(v.z + range) + m_height/2);
+
+	for (int y = y0; y <= y1; y++)
+		for (int x = x0; x <= x1; x++)
+			AddRunnersInRange(m_runnerHead.Get(x + y * m_width), v, range * range, ids);
+}
+
+// Finds the map grid index based on the 3d location
+int Map::HashLocation(Vec3 location)
+{
+	bool no=true;
+	int x = floor(location.x);
+	x+=m_width/2;
+	if (x<0)
+		no=false;
+	if (x>=m_width)
+		no=false;
+
+	int y = floor(location.z);		
+	y+=m_height/2;
+
+	if (y<0)
+		no=false;
+	if (y>=m_height)
+		no=false;
+	if (no)
+		return x + (y*m_width);
+	else
+		return -1;
+}
+
+// Finds the location for the center of the square for the vector given.
+Mat4x4 Map::GetGridLocation(Vec3 v)
+{
+	int x = floor(v.x);
+	int y = floor(v.z);	
+	Mat4x4 m;
+	m.BuildTranslation(x+0.5f, 0, y+0.5f);
+
+	return m;
+}
+
+// Gets the location for the center of the square with height and width for the vector
+Mat4x4 Map::GetGridLocation(Vec3 v, int height, int width)
+{
+	int x = floor(v.x);
+	int y = floor(v.z);	
+	Mat4x4 m;
+	m.BuildTranslation(x+width/2.0f, 0, y+height/2.0f);
+
+	return m;
+}
+
+// Gets the location for the map grid index
+Mat4x4 Map::GetGridLocation(int i)
+{
+	bool s = false;
+	Mat4x4 m = Mat4x4::g_Identity;
+
+	if (i < 0)
+	{
+		i = m_start;
+		s = true;
+	}
+
+	if (i < m_cells)
+	{
+		int x = i % m_width;
+		int y = i / m_width;
+		x -= m_width/2;
+		y -= m_height/2;
+		
+		if (s)
+			x--;
+
+		m.BuildTranslation(x+0.5f, 0, y+0.5f);
+	}
+
+	return m;
+}
+
+// Floods the walkability bitset out from the start square, a row of words at
+// a time, and tests if the flood gets to the end square. Each pass sweeps
+// down the rows then back up, every row taking the open squares next to what
+// the row before it reached, until a pass reaches nothing new.
+bool Map::IsEndReachable()
+{
+	if (!IsOpen(m_start) || !IsOpen(m_end))
+		return false;
+
+	int words = m_rowWords;
+	MapWord *reached = &m_reached[0];
+	const MapWord *open = &m_open[0];
+	std::fill(m_reached.begin(), m_reached.end(), (MapWord)0);
+
+	int startRow = m_start / m_width;
+	int endRow = m_end / m_width;
+	int endWord = endRow * words + (m_end % m_width) / MAP_WORD_BITS;
+	MapWord endBit = (MapWord)1 << (m_end % m_width % MAP_WORD_BITS);
+
+	int startWord = (m_start % m_width) / MAP_WORD_BITS;
+	reached[startRow * words + startWord] = (MapWord)1 << (m_start % m_width % MAP_WORD_BITS);
+	FillWord(reached + startRow * words, open + startRow * words, words, startWord);
+	if (reached[endWord] & endBit)
+		return true;
+
+	// Only the rows between top and bottom have anything in them yet.
+	int top = startRow, bottom = startRow;
+	bool grew = true;
+	while (grew)
+	{
+		grew = false;
+		for (int y = top + 1; y < m_height; y++)
+		{
+			if (!PullRow(reached + y * words, reached + (y - 1) * words, open + y * words, words))
+			{
+				if (y > bottom)
+					break;
+				continue;
+			}
+			grew = true;
+			bottom = max(bottom, y);
+			if (y == endRow && (reached[endWord] & endBit))
+				return true;
+		}
+
+		for (int y = bottom - 1; y >= 0; y--)
+		{
+			if (!PullRow(reached + y * words, reached + (y + 1) * words, open + y * words, words))
+			{
+				if (y < top)
+					break;
+				continue;
+			}
+			grew = true;
+			top = min(top, y);
+			if (y == endRow && (reached[endWord] & endBit))
+				return true;
+		}
+	}
+
+	return false;
+}
+
+// Tests if the end can still be reached from the start with the squares
+// under the footprint taken. Only the bitset is changed, and it is put back
+// to match the grid afterwards.
+bool Map::TestFootprint(int corner, int height, int width)
+{
+	for (int i = 0; i < height; i++)
+		for (int j = 0; j < width; j++)
+			SetOpen(corner + m_width*i + j, false);
+
+	bool b = IsEndReachable();
+
+	for (int i = 0; i < height; i++)
+		for (int j = 0; j < width; j++)
+			SetOpen(corner + m_width*i + j, m_grid.Get(corner + m_width*i + j) == INVALID_ACTOR_ID);
+
+	return b;
+}
+
+// Tests if the locatin will block movement to the end location from the beginning
+bool Map::CheckLocation(Vec3 loc)
+{
+	int t = HashLocation(loc);
+	if (t < 0)
+		return false;
+
+	return TestFootprint(t, 1, 1);
+}
+
+// Checks if the location is filled and if it blocks
+bool Map::IsLocationOccupied(Vec3 loc)
+{
+	int t = HashLocation(loc);
+	
+	if (t >= 0 && IsFree(t))
+	{
+		return CheckLocation(loc);
+	}
+
+	return false;
+}
+
+// Checks if the location is filled and if it blocks for a square
+bool Map::IsLocationOccupied(Vec3 loc, int height, int width)
+{
+	int t = HashLocation(loc);
+	if (t < 0 || t % m_width + width > m_width || t / m_width + height > m_height)
+		return false;
+
+	if (height == 2 && width == 2)
+	{
+		UpdatePlaceable();
+		return (m_placeable[GetBitWord(t)] & GetBitMask(t)) != 0;
+	}
+
+	for (int i = 0; i < height; i++)
+	{
+		for (int j = 0; j < width; j++)
+		{
+			if (!IsFree(t + m_width*i + j))
+				return false;
+		}
+	}
+
+	return TestFootprint(t, height, width);
+}
+
+// Gets the halves of the map's edge the square is on.
+int Map::GetEdgeSides(int cell) const
+{
+	int x = cell % m_width;
+	int y = cell / m_width;
+	int row = m_start / m_width;
+	int sides = 0;
+
+	if (y == m_height - 1)
+		sides |= SIDE_UPPER;
+	if (y == 0)
+		sides |= SIDE_LOWER;
+	if (x == 0 || x == m_width - 1)
+	{
+		if (y > row)
+			sides |= SIDE_UPPER;
+		else
+		if (y < row)
+			sides |= SIDE_LOWER;
+	}
+
+	return sides;
+}
+
+// Splits the taken squares into groups joined along edges or corners, and
+// works out which halves of the edge each group touches. Returns true if a
+// group touches both, which means the end is already cut off.
+bool Map::LabelBlockedGroups()
+{
+	m_blockGroup.Reset(-1);
+	m_groupSides.clear();
+	bool cut = false;
+
+	for (int c = 0; c < m_grid.GetChunkCount(); c++)
+	{
+		if (!m_grid.HasChunk(c))
+			continue;
+
+		int last = min(m_cells, (c + 1) * ChunkedGrid<ActorId>::CHUNK_SIZE);
+		for (int i = c * ChunkedGrid<ActorId>::CHUNK_SIZE; i < last; i++)
+		{
+			if (m_grid.Get(i) == INVALID_ACTOR_ID || m_blockGroup.Get(i) >= 0)
+				continue;
+
+			// Floods out over the taken squares joined to this one.
+			int group = m_groupSides.size();
+			int sides = 0;
+			m_blockGroup.Set(i, group);
+			m_groupStack.push_back(i);
+			while (!m_groupStack.empty())
+			{
+				int cell = m_groupStack.back();
+				m_groupStack.pop_back();
+				sides |= GetEdgeSides(cell);
+
+				int x = cell % m_width;
+				int y = cell / m_width;
+				for (int ty = max(0, y - 1); ty <= min(m_height - 1, y + 1); ty++)
+				{
+					for (int tx = max(0, x - 1); tx <= min(m_width - 1, x + 1); tx++)
+					{
+						int test = tx + ty * m_width;
+						if (m_grid.Get(test) != INVALID_ACTOR_ID && m_blockGroup.Get(test) < 0)
+						{
+							m_blockGroup.Set(test, group);
+							m_groupStack.push_back(test);
+						}
+					}
+				}
+			}
+
+			m_groupSides.push_back((unsigned char)sides);
+			if (sides == SIDE_BOTH)
+				cut = true;
+		}
+	}
+
+	return cut;
+}
+
+// Tests if a 2x2 tower can have its corner on this square. Its squares have
+// to be free, and together with the groups of taken
+// squares around it they can't touch both halves of the edge.
+bool Map::TestCorner(int corner)
+{
+	int x = corner % m_width;
+	int y = corner / m_width;
+	int sides = 0;
+
+	for (int i = 0; i < 2; i++)
+	{
+		for (int j = 0; j < 2; j++)
+		{
+			int cell = corner + m_width*i + j;
+			if (!IsFree(cell))
+				return false;
+			sides |= GetEdgeSides(cell);
+		}
+	}
+
+	for (int ty = max(0, y - 1); ty <= min(m_height - 1, y + 2); ty++)
+	{
+		for (int tx = max(0, x - 1); tx <= min(m_width - 1, x + 2); tx++)
+		{
+			int group = m_blockGroup.Get(tx + ty * m_width);
+			if (group >= 0)
+				sides |= m_groupSides[group];
+		}
+	}
+
+	return sides != SIDE_BOTH;
+}
+
+// Rechecks every 2x2 footprint that covers the square or touches it.
+void Map::UpdateCornersAround(int cell)
+{
+	int x = cell % m_width;
+	int y = cell / m_width;
+
+	for (int ty = max(0, y - 2); ty <= min(m_height - 2, y + 1); ty++)
+	{
+		for (int tx = max(0, x - 2); tx <= min(m_width - 2, x + 1); tx++)
+		{
+			int corner = tx + ty * m_width;
+			if (TestCorner(corner))
+				m_placeable[GetBitWord(corner)] |= GetBitMask(corner);
+			else
+				m_placeable[GetBitWord(corner)] &= ~GetBitMask(corner);
+		}
+	}
+}
+
+// Rebuilds the placement table if squares were taken or freed since it was
+// last built. A footprint away from every taken or reserved square can
+// always be built on, so only the footprints around those are checked one
+// by one.
+void Map::UpdatePlaceable()
+{
+	if (!m_placeableDirty)
+		return;
+	m_placeableDirty = false;
+
+	// Nothing can be built once the end is cut off.
+	std::fill(m_placeable.begin(), m_placeable.end(), (MapWord)0);
+	if (LabelBlockedGroups() || !IsOpen(m_start) || !IsOpen(m_end))
+		return;
+
+	// Every square with room for the footprint above and to the right of it.
+	for (int k = 0; k < m_rowWords; k++)
+	{
+		int corners = min(MAP_WORD_BITS, m_width - 1 - k * MAP_WORD_BITS);
+		MapWord word = corners >= MAP_WORD_BITS ? ~(MapWord)0 : ((MapWord)1 << max(0, corners)) - 1;
+		for (int y = 0; y < m_height - 1; y++)
+			m_placeable[y * m_rowWords + k] = word;
+	}
+
+	for (int c = 0; c < m_grid.GetChunkCount(); c++)
+	{
+		if (!m_grid.HasChunk(c))
+			continue;
+
+		int last = min(m_cells, (c + 1) * ChunkedGrid<ActorId>::CHUNK_SIZE);
+		for (int i = c * ChunkedGrid<ActorId>::CHUNK_SIZE; i < last; i++)
+		{
+			if (m_grid.Get(i) != INVALID_ACTOR_ID)
+				UpdateCornersAround(i);
+		}
+	}
+
+	for (int c = 0; c < m_cellFlags.GetChunkCount(); c++)
+	{
+		if (!m_cellFlags.HasChunk(c))
+			continue;
+
+		int last = min(m_cells, (c + 1) * ChunkedGrid<unsigned char>::CHUNK_SIZE);
+		for (int i = c * ChunkedGrid<unsigned char>::CHUNK_SIZE; i < last; i++)
+		{
+			if (m_cellFlags.Get(i) & CELL_RESERVED)
+				UpdateCornersAround(i);
+		}
+	}
+
+	// A footprint on a map two squares high touches both halves by itself.
+	if (m_height == 2)
+	{
+		for (int x = 0; x < m_width - 1; x++)
+			UpdateCornersAround(x);
+	}
+}
+
+// Starts a new search on the scratch buffers.
+void Map::NewSearch()
+{
+	m_openList.Clear();
+	m_searchId++;
+
+	// The stamps wrapped around, so old ones could look current again.
+	if (m_searchId == 0)
+	{
+		m_seen.Reset(0);
+		m_closed.Reset(0);
+		m_searchId = 1;
+	}
+}
+
+// Works out the square's lookahead distance from its neighbours and puts it
+// on the repair queue if that no longer matches its goal distance.
+void Map::UpdateCell(int cell)
+{
+	if (m_grid.Get(cell) != INVALID_ACTOR_ID)
+		m_rhs.Set(cell, kNoPath);
+	else
+	if (cell == m_end)
+		m_rhs.Set(cell, 0);
+	else
+	{
+		int around[4];
+		int count = GetNeighbours(cell, around);
+		int best = kNoPath;
+		for (int i = 0; i < count; i++)
+			best = min(best, m_goalDistance.Get(around[i]) + 1);
+		m_rhs.Set(cell, min(best, kNoPath));
+	}
+
+	if (m_fieldQueue.Contains(cell))
+		m_fieldQueue.Remove(cell);
+	if (m_goalDistance.Get(cell) != m_rhs.Get(cell))
+		m_fieldQueue.Push(cell, min(m_goalDistance.Get(cell), m_rhs.Get(cell)));
+}
+
+// Repairs the flow field around the squares taken or freed since the last
+// repair. Squares come off the queue closest first, so each one settles on
+// its final distance the first time its distance goes down.
+void Map::UpdateFlowField()
+{
+	if (m_changedCells.empty())
+		return;
+
+	for (unsigned int i = 0; i < m_changedCells.size(); i++)
+		UpdateCell(m_changedCells[i]);
+	m_changedCells.clear();
+
+	m_lastRepairCount = 0;
+	while (!m_fieldQueue.Empty())
+	{
+		int cell = m_fieldQueue.Pop();
+		m_lastRepairCount++;
+
+		// The square got closer, take the new distance. Otherwise it got
+		// further away, so drop it and let its neighbours tell it the new one.
+		if (m_goalDistance.Get(cell) > m_rhs.Get(cell))
+			m_goalDistance.Set(cell, m_rhs.Get(cell));
+		else
+		{
+			m_goalDistance.Set(cell, kNoPath);
+			UpdateCell(cell);
+		}
+
+		int around[4];
+		int count = GetNeighbours(cell, around);
+		for (int i = 0; i < count; i++)
+			UpdateCell(around[i]);
+	}
+}
+
+// Finds the square next to this one that is closest to the end, -1 if there isn't one.
+// A square a tower was just built on has no distance, so any open neighbour will do.
+int Map::GetNextStep(int cell)
+{
+	UpdateFlowField();
+
+	int best = -1;
+	int bestDistance = m_goalDistance.Get(cell);
+
+	int around[4];
+	int count = GetNeighbours(cell, around);
+	for (int i = 0; i < count; i++)
+	{
+		if (m_goalDistance.Get(around[i]) < bestDistance)
+		{
+			best = around[i];
+			bestDistance = m_goalDistance.Get(around[i]);
+		}
+	}
+
+	return best;
+}
+
+// Gets the square a runner at the location should move to next, -1 if it
+// should stay put. Runners off the map are first sent to the starting square.
+int Map::GetNextSquare(Vec3 v)
+{
+	int cur = HashLocation(v);
+	if (cur < 0)
+		return m_start;
+
+	return GetNextStep(cur);
+}
+
+// Fills the path with the squares a runner at the location will walk
+// through next, as many as fit. They're the squares GetNextSquare would give
+// the runner as it gets to each one, as long as no tower is built or sold
+// on the way.
+void Map::GetPath(Vec3 v, WaypointRing &path)
+{
+	path.Clear();
+	int next = GetNextSquare(v);
+	while (next >= 0 && path.Push(next))
+		next = GetNextStep(next);
+}
+
+// Fills in the path for a runner at each of the locations, the same paths
+// GetPath gives one at a time. The flow field is repaired once for the whole
+// batch and only read after that.
+void Map::GetPaths(const std::vector<Vec3> &locs, std::vector<WaypointRing> &paths)
+{
+	UpdateFlowField();
+	paths.resize(locs.size());
+	for (unsigned int i = 0; i < locs.size(); i++)
+		GetPath(locs[i], paths[i]);
+}
+
+// Gets how many steps the location is from the end, -1 if it is off the map or can't reach it.
+int Map::GetGoalDistance(Vec3 v)
+{
+	int cell = HashLocation(v);
+	if (cell < 0)
+		return -1;
+
+	UpdateFlowField();
+
+	return m_goalDistance.Get(cell) < kNoPath ? m_goalDistance.Get(cell) : -1;
+}
+
+// Gets how far a runner at x, z in the cell still has to go to the end: the
+// goal distance of the cell, less how far past its middle the runner is
+// towards the next square. So two runners in the same square are told apart,
+// and the value doesn't jump as a runner crosses into the next square.
+// Runners off the map or cut off from the end get kNoPath.
+float Map::GetRunnerProgress(int cell, int next, float x, float z) const
+{
+	if (cell < 0 || m_goalDistance.Get(cell) >= kNoPath)
+		return (float)kNoPath;
+	if (next < 0)
+		return (float)m_goalDistance.Get(cell);
+
+	float cx = (float)(cell % m_width - m_width/2) + 0.5f;
+	float cz = (float)(cell / m_width - m_height/2) + 0.5f;
+	float stepX = (float)(next % m_width - cell % m_width);
+	float stepZ = (float)(next / m_width - cell / m_width);
+	return (float)m_goalDistance.Get(cell) - ((x - cx) * stepX + (z - cz) * stepZ);
+}
+
+// Gets how far a runner at the location still has to go to the end, the
+// progress TP_FIRST and TP_LAST rank runners by. -1 if it can't get there.
+float Map::GetPathProgress(Vec3 v)
+{
+	int cell = HashLocation(v);
+	if (cell < 0)
+		return -1;
+
+	int next = GetNextStep(cell);
+	float progress = GetRunnerProgress(cell, next, v.x, v.z);
+	return progress < (float)kNoPath ? progress : -1;
+}
+
+// Tests if the runner is at the end.
+bool Map::TestRunnerAtEnd(shared_ptr<IActor> actor)
+{
+	return TestRunnerAtEnd(actor->VGet()->m_Mat.GetPosition());
+}
+
+// Tests if a runner at the location is at the end.
+bool Map::TestRunnerAtEnd(Vec3 v)
+{
+	return HashLocation(v) == m_end;
+}
+
+// Finds the actor at the given location
+ActorId Map::GetActorAtLoc(Vec3 v)
+{
+	int test = HashLocation(v);
+	if (test < 0)
+		return INVALID_ACTOR_ID;
+	return m_grid.Get(test);
+}
+
+// Takes the actor off the map using the footprint kept when it was added.
+// Returns true if a tower's squares were freed.
+bool Map::RemoveActor(ActorId id)
+{
+	FootprintMap::iterator it = m_footprints.find(id);
+	if (it == m_footprints.end())
+		return false;
+
+	MapFootprint footprint = (*it).second;
+	m_footprints.erase(it);
+
+	if (footprint.m_type == AT_RUNNER)
+	{
+		SetRunnerCell(footprint, -1);
+		UnlinkRunner(footprint.m_slot, -1);
+		m_freeRunners.push_back(footprint.m_slot);
+		return false;
+	}
+
+	for (int i = 0; i < footprint.m_height; i++)
+	{
+		for (int j = 0; j < footprint.m_width; j++)
+		{
+			int cell = footprint.m_corner + m_width*i + j;
+			if (m_grid.Get(cell) == id)
+				SetCell(cell, INVALID_ACTOR_ID);
+		}
+	}
+
+	return true;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////Map Clusters///////////////////////////////////////////////
+/////////////////////////////////////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////////////////////////////////////
+
+// Marks the clusters whose portals can change when the square is taken or
+// freed: its own, and the one across the edge if the square is on one.
+void Map::DirtyClusters(int cell)
+{
+	if (m_clusters.empty())
+		return;
+
+	int x = cell % m_width;
+	int y = cell / m_width;
+	int cluster = GetCluster(cell);
+	int around[5];
+	int count = 0;
+
+	around[count++] = cluster;
+	if (x % CLUSTER_SIZE == 0 && x > 0)
+		around[count++] = cluster - 1;
+	if (x % CLUSTER_SIZE == CLUSTER_SIZE - 1 && x + 1 < m_width)
+		around[count++] = cluster + 1;
+	if (y % CLUSTER_SIZE == 0 && y > 0)
+		around[count++] = cluster - m_clustersX;
+	if (y % CLUSTER_SIZE == CLUSTER_SIZE - 1 && y + 1 < m_height)
+		around[count++] = cluster + m_clustersX;
+
+	for (int i = 0; i < count; i++)
+	{
+		if (!m_clusters[around[i]].m_dirty)
+		{
+			m_clusters[around[i]].m_dirty = true;
+			m_dirtyClusters.push_back(around[i]);
+		}
+	}
+}
+
+// Walks out from the square without leaving its cluster, filling
+// m_clusterDist with the steps to every square of the cluster.
+void Map::SearchCluster(int cluster, int from)
+{
+	int x0 = cluster % m_clustersX * CLUSTER_SIZE;
+	int y0 = cluster / m_clustersX * CLUSTER_SIZE;
+	int x1 = min(x0 + CLUSTER_SIZE, m_width);
+	int y1 = min(y0 + CLUSTER_SIZE, m_height);
+
+	std::fill(m_clusterDist.begin(), m_clusterDist.end(), kNoPath);
+	m_clusterQueue.clear();
+	if (!IsOpen(from))
+		return;
+
+	m_clusterDist[from % m_width - x0 + (from / m_width - y0) * CLUSTER_SIZE] = 0;
+	m_clusterQueue.push_back(from);
+	for (unsigned int head = 0; head < m_clusterQueue.size(); head++)
+	{
+		int cell = m_clusterQueue[head];
+		int x = cell % m_width;
+		int y = cell / m_width;
+		int d = m_clusterDist[x - x0 + (y - y0) * CLUSTER_SIZE] + 1;
+
+		for (int i = 0; i < 4; i++)
+		{
+			int tx = x + kStepX[i], ty = y + kStepY[i];
+			if (tx < x0 || tx >= x1 || ty < y0 || ty >= y1)
+				continue;
+
+			int test = tx + ty * m_width;
+			int &dist = m_clusterDist[tx - x0 + (ty - y0) * CLUSTER_SIZE];
+			if (dist <= d || !IsOpen(test))
+				continue;
+
+			dist = d;
+			m_clusterQueue.push_back(test);
+		}
+	}
+}
+
+// Gets the steps to a square of the cluster from the last SearchCluster.
+int Map::GetClusterDist(int cluster, int cell) const
+{
+	int x0 = cluster % m_clustersX * CLUSTER_SIZE;
+	int y0 = cluster / m_clustersX * CLUSTER_SIZE;
+	return m_clusterDist[cell % m_width - x0 + (cell / m_width - y0) * CLUSTER_SIZE];
+}
+
+// Adds a portal in the middle of each run of squares along one edge of the
+// cluster that are open on both sides. The edge is count squares long,
+// starting at the inside square and going by step, and across is the step
+// over the edge. The cluster on the other side finds the same runs.
+void Map::AddPortals(int cluster, int inside, int step, int across, int count)
+{
+	PathCluster &c = m_clusters[cluster];
+	int run = 0;
+
+	for (int i = 0; i <= count; i++)
+	{
+		int cell = inside + i * step;
+		if (i < count && IsOpen(cell) && IsOpen(cell + across))
+		{
+			run++;
+			continue;
+		}
+
+		if (run > 0)
+		{
+			int portal = inside + (i - run + (run - 1) / 2) * step;
+			c.m_nodes.push_back(portal);
+			c.m_links.push_back(portal + across);
+			run = 0;
+		}
+	}
+}
+
+// Finds the cluster's portals and the steps between each pair of them.
+void Map::BuildCluster(int cluster)
+{
+	PathCluster &c = m_clusters[cluster];
+	c.m_nodes.clear();
+	c.m_links.clear();
+
+	int cx = cluster % m_clustersX;
+	int cy = cluster / m_clustersX;
+	int x0 = cx * CLUSTER_SIZE;
+	int y0 = cy * CLUSTER_SIZE;
+	int w = min(x0 + CLUSTER_SIZE, m_width) - x0;
+	int h = min(y0 + CLUSTER_SIZE, m_height) - y0;
+	int corner = x0 + y0 * m_width;
+
+	if (cx > 0)
+		AddPortals(cluster, corner, m_width, -1, h);
+	if (cx + 1 < m_clustersX)
+		AddPortals(cluster, corner + w - 1, m_width, 1, h);
+	if (cy > 0)
+		AddPortals(cluster, corner, 1, -m_width, w);
+	if (cy + 1 < m_clustersY)
+		AddPortals(cluster, corner + (h - 1) * m_width, 1, m_width, w);
+
+	int n = c.m_nodes.size();
+	c.m_cost.assign(n * n, kNoPath);
+	for (int i = 0; i < n; i++)
+	{
+		SearchCluster(cluster, c.m_nodes[i]);
+		for (int j = 0; j < n; j++)
+			c.m_cost[i * n + j] = GetClusterDist(cluster, c.m_nodes[j]);
+	}
+
+	c.m_dirty = false;
+}
+
+// Builds every cluster the first time, then only the dirty ones.
+void Map::UpdateClusters()
+{
+	if (m_clusters.empty())
+	{
+		m_clusters.resize(m_clustersX * m_clustersY);
+		for (int i = 0; i < m_clustersX * m_clustersY; i++)
+			BuildCluster(i);
+		m_dirtyClusters.clear();
+		return;
+	}
+
+	for (unsigned int i = 0; i < m_dirtyClusters.size(); i++)
+	{
+		if (m_clusters[m_dirtyClusters[i]].m_dirty)
+			BuildCluster(m_dirtyClusters[i]);
+	}
+	m_dirtyClusters.clear();
+}
+
+// Offers a shorter way to a square in the portal search.
+void Map::RelaxNode(int cell, int parent, int G, int end)
+{
+	if (m_closed.Get(cell) == m_searchId)
+		return;
+
+	int H = abs(cell % m_width - end % m_width) + abs(cell / m_width - end / m_width);
+	if (m_seen.Get(cell) != m_searchId)
+	{
+		m_seen.Ref(cell) = m_searchId;
+		m_G.Ref(cell) = G;
+		m_parent.Ref(cell) = parent;
+		m_openList.Push(cell, G + H);
+	}
+	else
+	if (G < m_G.Get(cell))
+	{
+		m_G.Ref(cell) = G;
+		m_parent.Ref(cell) = parent;
+		m_openList.Decrease(cell, G + H);
+	}
+}
+
+// Searches from the start square to the end square over the cluster portals.
+// Fills waypoints with the start, the portal squares the path goes through
+// and the end, and returns the number of steps, or -1 if there is no path.
+// Each pair of waypoints is either next to each other or in the same
+// cluster, see RefineClusterLeg.
+int Map::FindClusterPath(int start, int end, std::vector<int> &waypoints)
+{
+	waypoints.clear();
+	if (start < 0 || start >= m_cells || end < 0 || end >= m_cells || !IsOpen(start) || !IsOpen(end))
+		return -1;
+
+	UpdateClusters();
+
+	// Steps from each portal of the end's cluster to the end.
+	int endCluster = GetCluster(end);
+	PathCluster &ec = m_clusters[endCluster];
+	SearchCluster(endCluster, end);
+	m_endDist.resize(ec.m_nodes.size());
+	for (unsigned int i = 0; i < ec.m_nodes.size(); i++)
+		m_endDist[i] = GetClusterDist(endCluster, ec.m_nodes[i]);
+
+	NewSearch();
+	m_seen.Ref(start) = m_searchId;
+	m_G.Ref(start) = 0;
+	m_parent.Ref(start) = -1;
+	m_openList.Push(start, 0);
+
+	bool found = false;
+	while (!m_openList.Empty())
+	{
+		int cur = m_openList.Pop();
+		m_closed.Ref(cur) = m_searchId;
+		if (cur == end)
+		{
+			found = true;
+			break;
+		}
+
+		int G = m_G.Get(cur);
+		int cluster = GetCluster(cur);
+		PathCluster &c = m_clusters[cluster];
+		int n = c.m_nodes.size();
+
+		// The start isn't a portal, so walk out to its cluster's portals.
+		if (cur == start)
+		{
+			SearchCluster(cluster, start);
+			for (int j = 0; j < n; j++)
+			{
+				int d = GetClusterDist(cluster, c.m_nodes[j]);
+				if (d < kNoPath)
+					RelaxNode(c.m_nodes[j], cur, G + d, end);
+			}
+			if (cluster == endCluster && GetClusterDist(cluster, end) < kNoPath)
+				RelaxNode(end, cur, G + GetClusterDist(cluster, end), end);
+		}
+
+		for (int i = 0; i < n; i++)
+		{
+			if (c.m_nodes[i] != cur)
+				continue;
+
+			RelaxNode(c.m_links[i], cur, G + 1, end);
+			for (int j = 0; j < n; j++)
+			{
+				if (c.m_cost[i * n + j] < kNoPath)
+					RelaxNode(c.m_nodes[j], cur, G + c.m_cost[i * n + j], end);
+			}
+			if (cluster == endCluster && m_endDist[i] < kNoPath)
+				RelaxNode(end, cur, G + m_endDist[i], end);
+		}
+	}
+
+	if (!found)
+		return -1;
+
+	for (int cur = end; cur >= 0; cur = m_parent.Get(cur))
+		waypoints.push_back(cur);
+	std::reverse(waypoints.begin(), waypoints.end());
+
+	return m_G.Get(end);
+}
+
+// Works out the squares between two waypoints of a cluster path, not
+// counting the from square. Returns the number of steps, or -1 if the two
+// aren't joined inside one cluster.
+int Map::RefineClusterLeg(int from, int to, std::vector<int> &cells)
+{
+	cells.clear();
+	if (abs(from % m_width - to % m_width) + abs(from / m_width - to / m_width) == 1)
+	{
+		cells.push_back(to);
+		return 1;
+	}
+
+	int cluster = GetCluster(to);
+	if (GetCluster(from) != cluster)
+		return -1;
+
+	// Walks down the distances to the to square.
+	SearchCluster(cluster, to);
+	int cur = from;
+	int d = GetClusterDist(cluster, cur);
+	if (d >= kNoPath)
+		return -1;
+
+	while (d > 0)
+	{
+		int around[4];
+		int count = GetNeighbours(cur, around);
+		for (int i = 0; i < count; i++)
+		{
+			if (GetCluster(around[i]) == cluster && GetClusterDist(cluster, around[i]) == d - 1)
+			{
+				cur = around[i];
+				break;
+			}
+		}
+		cells.push_back(cur);
+		d--;
+	}
+
+	return cells.size();
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////CellHeap///////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////////////////////////////////////
+
+// Sizes the heap for a grid with this many squares.
+void CellHeap::Init(int cells)
+{
+	m_heap.clear();
+	m_index.Init(cells, -1);
+}
+
+// Empties the heap. Only touches the squares still in it.
+void CellHeap::Clear()
+{
+	for (unsigned int i = 0; i < m_heap.size(); i++)
+		m_index.Ref(m_heap[i].cell) = -1;
+	m_heap.clear();
+}
+
+// Adds a square with the given cost.
+void CellHeap::Push(int cell, int key)
+{
+	Entry e;
+	e.cell = cell;
+	e.key = key;
+	m_index.Ref(cell) = m_heap.size();
+	m_heap.push_back(e);
+	SiftUp(m_heap.size() - 1);
+}
+
+// Lowers the cost of a square that is already in the heap.
+void CellHeap::Decrease(int cell, int key)
+{
+	int i = m_index.Get(cell);
+	m_heap[i].key = key;
+	SiftUp(i);
+}
+
+// Takes a square out of the heap.
+void CellHeap::Remove(int cell)
+{
+	int i = m_index.Get(cell);
+	int last = m_heap.size() - 1;
+	Swap(i, last);
+	m_heap.pop_back();
+	m_index.Ref(cell) = -1;
+	if (i < last)
+	{
+		SiftUp(i);
+		SiftDown(i);
+	}
+}
+
+// Removes and returns the square with the lowest cost.
+int CellHeap::Pop()
+{
+	int top = m_heap[0].cell;
+	Swap(0, m_heap.size() - 1);
+	m_heap.pop_back();
+	m_index.Ref(top) = -1;
+	if (!m_heap.empty())
+		SiftDown(0);
+	return top;
+}
+
+// Moves the entry at i up until its parent costs no more than it.
+void CellHeap::SiftUp(int i)
+{
+	while (i > 0)
+	{
+		int parent = (i - 1) / 2;
+		if (m_heap[parent].key <= m_heap[i].key)
+			break;
+		Swap(i, parent);
+		i = parent;
+	}
+}
+
+// Moves the entry at i down until neither child costs less than it.
+void CellHeap::SiftDown(int i)
+{
+	int size = m_heap.size();
+	while (true)
+	{
+		int smallest = i;
+		int left = 2 * i + 1, right = left + 1;
+		if (left < size && m_heap[left].key < m_heap[smallest].key)
+			smallest = left;
+		if (right < size && m_heap[right].key < m_heap[smallest].key)
+			smallest = right;
+		if (smallest == i)
+			break;
+		Swap(i, smallest);
+		i = smallest;
+	}
+}
+
+// Swaps two heap entries and keeps their positions up to date.
+void CellHeap::Swap(int a, int b)
+{
+	Entry t = m_heap[a];
+	m_heap[a] = m_heap[b];
+	m_heap[b] = t;
+	m_index.Ref(m_heap[a].cell) = a;
+	m_index.Ref(m_heap[b].cell) = b;
+}
@@ -0,0 +1,344 @@
+#pragma once
+
+#include "StdHeader.h"
+#include "WaypointRing.h"
+
+// Size of the map when map.lua doesn't give one, and the largest it can be.
+const int	DEFAULT_MAP_SIZE = 20;
+const int	MAX_MAP_SIZE = 4096;
+
+// A word of the packed walkability bitset, one bit per square.
+#ifdef _MSC_VER
+typedef unsigned __int64 MapWord;
+#else
+typedef unsigned long long MapWord;
+#endif
+const int	MAP_WORD_BITS = 64;
+
+// One value for every square on the map. The squares are split into chunks,
+// runs of CHUNK_SIZE squares in row order, and a chunk is only allocated the
+// first time something other than the default value is written into it, so
+// the empty parts of a big map take no memory. Finding a square is a shift
+// and a mask however big the map is.
+template <typename T>
+class ChunkedGrid
+{
+	std::vector<T *>	m_chunks;
+	T					m_default;
+
+	ChunkedGrid(const ChunkedGrid &);
+	ChunkedGrid &operator = (const ChunkedGrid &);
+
+public:
+	enum { CHUNK_SHIFT = 10, CHUNK_SIZE = 1 << CHUNK_SHIFT, CHUNK_MASK = CHUNK_SIZE - 1 };
+
+	ChunkedGrid():m_default() {}
+	~ChunkedGrid() {Reset(m_default);}
+
+	// Sizes the grid for this many squares, all holding the default value.
+	void Init(int cells, T def)
+	{
+		Reset(def);
+		m_chunks.assign((cells + CHUNK_MASK) >> CHUNK_SHIFT, (T *)NULL);
+	}
+
+	// Frees every chunk, which puts every square back to the default value.
+	void Reset(T def)
+	{
+		for (unsigned int i = 0; i < m_chunks.size(); i++)
+		{
+			SAFE_DELETE_ARRAY(m_chunks[i]);
+		}
+		m_default = def;
+	}
+
+	T Get(int cell) const
+	{
+		const T *chunk = m_chunks[cell >> CHUNK_SHIFT];
+		return chunk ? chunk[cell & CHUNK_MASK] : m_default;
+	}
+
+	// Gets the square to write to, allocating its chunk if it needs one.
+	T &Ref(int cell)
+	{
+		T *&chunk = m_chunks[cell >> CHUNK_SHIFT];
+		if (!chunk)
+		{
+			chunk = SAFE_NEW T[CHUNK_SIZE];
+			std::fill(chunk, chunk + CHUNK_SIZE, m_default);
+		}
+		return chunk[cell & CHUNK_MASK];
+	}
+
+	void Set(int cell, T value)
+	{
+		if (m_chunks[cell >> CHUNK_SHIFT] || !(value == m_default))
+			Ref(cell) = value;
+	}
+
+	int GetChunkCount() const {return m_chunks.size();}
+	bool HasChunk(int chunk) const {return m_chunks[chunk] != NULL;}
+};
+
+// Min-heap of grid squares ordered by their F cost, used as the A* open list.
+// Keeps each square's place in the heap so a square already on the open list
+// can have its cost lowered in place.
+class CellHeap
+{
+	struct Entry
+	{
+		int cell, key;
+	};
+
+	std::vector<Entry>	m_heap;
+	ChunkedGrid<int>	m_index;
+
+	void SiftUp(int i);
+	void SiftDown(int i);
+	void Swap(int a, int b);
+
+public:
+	void Init(int cells);
+	void Clear();
+	bool Empty() const {return m_heap.empty();}
+	bool Contains(int cell) const {return m_index.Get(cell) >= 0;}
+	void Push(int cell, int key);
+	void Decrease(int cell, int key);
+	void Remove(int cell);
+	int Pop();
+};
+
+// Flags kept for each square of the map.
+enum CellFlags
+{
+	CELL_RESERVED = 1		// Nothing can be built on the square.
+};
+
+// The squares an actor has on the map, kept so the actor can be taken off
+// again without searching the grid. A tower owns every square of its
+// footprint, a runner is listed in the one square it's in. m_corner is the
+// lowest square of the footprint, -1 while the actor is off the map.
+// m_slot is a runner's place in the map's runner table.
+struct MapFootprint
+{
+	ActorType	m_type;
+	int			m_corner;
+	int			m_width;
+	int			m_height;
+	int			m_slot;
+
+	MapFootprint(ActorType type=AT_UNKNOWN, int corner=-1, int width=1, int height=1):
+		m_type(type), m_corner(corner), m_width(width), m_height(height), m_slot(-1) {}
+};
+
+// A runner in the map's spatial hash. Runners in the same square are linked
+// together through m_next and m_prev, which are places in the runner table.
+struct MapRunner
+{
+	ActorId		m_id;
+	float		m_x;
+	float		m_z;
+	float		m_life;
+	int			m_next;
+	int			m_prev;
+};
+typedef std::map<ActorId, MapFootprint> FootprintMap;
+
+// A square block of the map used by the hierarchical search. m_nodes are
+// the cluster's portal squares, m_links the square across the cluster's edge
+// each one leads to, and m_cost the steps between every pair of nodes
+// without leaving the cluster (m_nodes.size() squared, row by row). A square
+// that is a portal on two edges is in m_nodes once for each.
+struct PathCluster
+{
+	std::vector<int>	m_nodes;
+	std::vector<int>	m_links;
+	std::vector<int>	m_cost;
+	bool				m_dirty;
+
+	PathCluster():m_dirty(true) {}
+};
+
+// Used to hold information about the playing area.
+class Map
+{
+	friend class TowerGame;
+	int			m_width;
+	int			m_height;
+	int			m_cells;
+	int			m_start;
+	int			m_end;
+
+	// The layers of the map. m_grid holds the tower that owns each square,
+	// INVALID_ACTOR_ID if none does, and m_cellFlags its CellFlags. The
+	// start and end squares are reserved, and placement keeps off them.
+	ChunkedGrid<ActorId>	m_grid;
+	ChunkedGrid<unsigned char>	m_cellFlags;
+	FootprintMap			m_footprints;
+
+	// Spatial hash of the runners, keyed by square. m_runnerHead is the first
+	// runner in each square's list, -1 if it is empty, and runners off the map
+	// are listed from m_offMapHead. A runner is only moved between lists when
+	// it crosses into another square.
+	std::vector<MapRunner>	m_runners;
+	std::vector<int>		m_freeRunners;
+	ChunkedGrid<int>		m_runnerHead;
+	int						m_offMapHead;
+
+	// The runners' positions packed into arrays for FindClosestRunners and
+	// FindTargets, off the map runners first and then sorted by square, so
+	// the runners in a run of squares along a row sit next to each other.
+	// Each targeting policy has its own keys, the lowest key is the target.
+	std::vector<float>		m_packX;
+	std::vector<float>		m_packZ;
+	std::vector<ActorId>	m_packId;
+	std::vector<int>		m_packCell;
+	std::vector<float>		m_packKeys[TP_COUNT];
+	int						m_packOffMap;
+
+	// The squares with runners in them, in order, where each square's runners
+	// start in the packed arrays, and each policy's best runner in the square.
+	std::vector<int>		m_packSquares;
+	std::vector<int>		m_packSquareStart;
+	std::vector<float>		m_squareKeys[TP_COUNT];
+	std::vector<ActorId>	m_squareIds[TP_COUNT];
+	std::vector<int>		m_edgeSquares;
+
+	// Portal search scratch for FindClusterPath, one entry per square. A
+	// square's G and parent are only valid when its m_seen stamp matches
+	// m_searchId, so nothing needs clearing between searches. The grids are
+	// chunked, so they take no memory until a search writes to them.
+	CellHeap				m_openList;
+	ChunkedGrid<int>		m_G;
+	ChunkedGrid<int>		m_parent;
+	ChunkedGrid<unsigned>	m_seen;
+	ChunkedGrid<unsigned>	m_closed;
+	unsigned				m_searchId;
+
+	// Number of steps from each square to the end square. Every runner follows
+	// this one field down to the end. It is kept up to date incrementally
+	// (LPA* rooted at the end square): when squares are taken or freed only the
+	// squares whose distance actually changes are visited. m_rhs is the
+	// one-step lookahead distance, and a square is on m_fieldQueue while the
+	// two disagree.
+	ChunkedGrid<int>		m_goalDistance;
+	ChunkedGrid<int>		m_rhs;
+	CellHeap				m_fieldQueue;
+	std::vector<int>		m_changedCells;
+	int						m_lastRepairCount;
+
+	// One bit per square, set while the square is open. Every row starts on a
+	// new word so a whole row can be flooded a word at a time. m_reached is
+	// the scratch the flood fills in.
+	std::vector<MapWord>	m_open;
+	std::vector<MapWord>	m_reached;
+	int						m_rowWords;
+
+	// Which squares a 2x2 tower can have its corner on without cutting the
+	// start off from the end, laid out like m_open. The map's edge is split in
+	// two by the start and end squares, and the end is cut off exactly when
+	// a group of taken squares, joined along edges or corners, touches both
+	// halves. So each group is labelled with the halves it touches, and a
+	// footprint is only checked against the groups around it. The table is
+	// rebuilt the first time it's used after squares are taken or freed.
+	std::vector<MapWord>		m_placeable;
+	ChunkedGrid<int>			m_blockGroup;
+	std::vector<unsigned char>	m_groupSides;
+	std::vector<int>			m_groupStack;
+	bool						m_placeableDirty;
+
+	// Hierarchical search (HPA*) for long paths on big maps. The map is cut
+	// into CLUSTER_SIZE square clusters. Where two clusters meet, each run of
+	// squares open on both sides of the edge gets a portal in its middle, and
+	// each cluster knows the shortest way between its own portals. A long
+	// search then only runs over portals, and the path is worked out square by
+	// square one cluster at a time as it is walked. Taking or freeing a square
+	// only dirties the cluster it is in, and the one across the edge if it is
+	// on one. Clusters are built the first time they're searched.
+	enum { CLUSTER_SIZE = 16 };
+	std::vector<PathCluster>	m_clusters;
+	std::vector<int>			m_dirtyClusters;
+	std::vector<int>			m_clusterDist;
+	std::vector<int>			m_clusterQueue;
+	std::vector<int>			m_endDist;
+	int							m_clustersX;
+	int							m_clustersY;
+
+	int GetNeighbours(int cell, int *out);
+	void SetRunnerCell(MapFootprint &footprint, int cell);
+	void LinkRunner(int slot, int cell);
+	void UnlinkRunner(int slot, int cell);
+	void CheckRunners(int slot, Vec3 v, ActorId &best, float &bestSq);
+	void AddRunnersInRange(int slot, Vec3 v, float rangeSq, std::vector<ActorId> &ids);
+	void RankRunners(int slot, int cell, int next, Vec3 v, float rangeSq, int policy, ActorId &best, float &bestKey);
+	bool ShouldPackTargets(int shots);
+	void PackRunners(bool withKeys);
+	void PackRunner(int slot, int cell, int next, bool withKeys);
+	void PackSquare(int cell, int start);
+	bool GetRowReach(int y, Vec3 v, float reachSq, int &first, int &last);
+	ActorId ClosestPacked(Vec3 v, float range);
+	ActorId BestPacked(Vec3 v, float range, int policy);
+	bool IsFree(int cell) const {return m_grid.Get(cell) == INVALID_ACTOR_ID && !(m_cellFlags.Get(cell) & CELL_RESERVED);}
+	int GetBitWord(int cell) const {return (cell / m_width) * m_rowWords + cell % m_width / MAP_WORD_BITS;}
+	MapWord GetBitMask(int cell) const {return (MapWord)1 << (cell % m_width % MAP_WORD_BITS);}
+	void SetOpen(int cell, bool open);
+	bool IsOpen(int cell) const;
+	bool IsEndReachable();
+	bool TestFootprint(int corner, int height, int width);
+	int GetEdgeSides(int cell) const;
+	bool LabelBlockedGroups();
+	bool TestCorner(int corner);
+	void UpdateCornersAround(int cell);
+	void UpdatePlaceable();
+	int GetCluster(int cell) const {return (cell % m_width) / CLUSTER_SIZE + (cell / m_width) / CLUSTER_SIZE * m_clustersX;}
+	void DirtyClusters(int cell);
+	void SearchCluster(int cluster, int from);
+	int GetClusterDist(int cluster, int cell) const;
+	void AddPortals(int cluster, int inside, int step, int across, int count);
+	void BuildCluster(int cluster);
+	void UpdateClusters();
+	void RelaxNode(int cell, int parent, int G, int end);
+	void NewSearch();
+	void UpdateCell(int cell);
+	int GetNextStep(int cell);
+	float GetRunnerProgress(int cell, int next, float x, float z) const;
+
+public:
+	Map(int width=DEFAULT_MAP_SIZE, int height=DEFAULT_MAP_SIZE);
+	void Init(int width, int height);
+	int GetWidth() {return m_width;}
+	int GetHeight() {return m_height;}
+	int GetStart() {return m_start;}
+	int GetEnd() {return m_end;}
+	void SetCell(int cell, ActorId id);
+	int HashLocation(Vec3 loc);
+	bool AddActor(shared_ptr<IActor> actor);
+	void AddRunner(ActorId id, Vec3 loc, float life = 0);
+	bool RemoveActor(ActorId id);
+	void MoveActor(ActorId id, Vec3 v);
+	ActorId FindClosestRunner(Vec3 v, float range);
+	ActorId FindBestRunner(Vec3 v, float range, int policy);
+	void FindClosestRunners(const std::vector<Vec3> &locs, const std::vector<float> &ranges, std::vector<ActorId> &targets);
+	void FindTargets(const std::vector<Vec3> &locs, const std::vector<float> &ranges, const std::vector<int> &policies,
+		std::vector<ActorId> &targets);
+	void SetRunnerLife(ActorId id, float life);
+	void GetRunnersInRange(Vec3 v, float range, std::vector<ActorId> &ids);
+	Mat4x4 GetGridLocation(Vec3 v);
+	Mat4x4 GetGridLocation(Vec3 v, int height, int width);
+	Mat4x4 GetGridLocation(int i);
+	bool CheckLocation(Vec3 v);
+	int GetNextSquare(Vec3 v);
+	void GetPath(Vec3 v, WaypointRing &path);
+	void GetPaths(const std::vector<Vec3> &locs, std::vector<WaypointRing> &paths);
+	int GetGoalDistance(Vec3 v);
+	float GetPathProgress(Vec3 v);
+	void UpdateFlowField();
+	int GetLastRepairCount() {return m_lastRepairCount;}
+	bool TestRunnerAtEnd(shared_ptr<IActor> actor);
+	bool TestRunnerAtEnd(Vec3 v);
+	ActorId GetActorAtLoc(Vec3 v);
+	bool IsLocationOccupied(Vec3 v);
+	bool IsLocationOccupied(Vec3 v, int height, int width);
+	int FindClusterPath(int start, int end, std::vector<int> &waypoints);
+	int RefineClusterLeg(int from, int to, std::vector<int> &cells);
+};
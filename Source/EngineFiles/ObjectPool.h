@@ -0,0 +1,99 @@
+#pragma once
+
+#include "StdHeader.h"
+#include <new>
+
+// Fixed-size slots for one class of object, taken from blocks of
+// m_blockSize slots. A freed slot goes on a free list and is handed out
+// again before a new block is allocated, so once the pool has grown to the
+// most objects alive at once it never calls the allocator again.
+template <typename T>
+class ObjectPool
+{
+	union Slot
+	{
+		char		m_object[sizeof(T)];
+		Slot		*m_next;
+		double		m_align;
+	};
+
+	std::vector<Slot *>	m_blocks;
+	Slot				*m_free;
+	int					m_blockSize;
+	int					m_live;
+
+	ObjectPool(const ObjectPool &);
+	ObjectPool &operator = (const ObjectPool &);
+
+	// Allocates another block and puts its slots on the free list.
+	void Grow()
+	{
+		Slot *block = (Slot *)::operator new(sizeof(Slot) * m_blockSize);
+		m_blocks.push_back(block);
+		for (int i = m_blockSize - 1; i >= 0; i--)
+		{
+			block[i].m_next = m_free;
+			m_free = &block[i];
+		}
+	}
+
+public:
+	// Takes the first block up front so the first objects don't allocate.
+	explicit ObjectPool(int blockSize):m_free(NULL),m_blockSize(blockSize),m_live(0) {Grow();}
+
+	// The blocks are only given back if every object has been freed. The
+	// pools outlive the game, but something still holding an actor when the
+	// program exits would otherwise be left pointing at freed memory.
+	~ObjectPool()
+	{
+		if (m_live > 0)
+			return;
+
+		for (unsigned int i = 0; i < m_blocks.size(); i++)
+			::operator delete(m_blocks[i]);
+	}
+
+	// Gets memory for one object, to build it in with placement new.
+	void *Allocate()
+	{
+		if (!m_free)
+			Grow();
+
+		Slot *slot = m_free;
+		m_free = slot->m_next;
+		m_live++;
+		return slot;
+	}
+
+	// Puts an object's memory back on the free list.
+	void Free(void *p)
+	{
+		Slot *slot = (Slot *)p;
+		slot->m_next = m_free;
+		m_free = slot;
+		m_live--;
+	}
+
+	// Destroys an object built in the pool and frees its slot.
+	void Destroy(T *object)
+	{
+		object->~T();
+		Free(object);
+	}
+
+	// Hands an object built in the pool to a shared_ptr that gives it back
+	// to the pool when the last reference goes.
+	shared_ptr<T> Own(T *object) {return shared_ptr<T>(object, Deleter(this));}
+
+	// shared_ptr deleter for objects from the pool.
+	class Deleter
+	{
+		ObjectPool		*m_pool;
+	public:
+		explicit Deleter(ObjectPool *pool):m_pool(pool) {}
+		void operator () (T *object) {m_pool->Destroy(object);}
+	};
+};
+
+// Builds an object in memory from the pool, used like SAFE_NEW.
+#define POOL_NEW(pool) new ((pool).Allocate())
@@ -5,8 +5,8 @@
 #pragma once
 
 #include "StdHeader.h"
-#include <boost\config.hpp>
-#include <boost\shared_ptr.hpp>
+#include <boost/config.hpp>
+#include <boost/shared_ptr.hpp>
 #include <list>
 #include "Event.h"
 
@@ -43,7 +43,7 @@ public:
 	virtual ActorId GetId() {return m_id;}
 	virtual void SetActorId(ActorId id) {m_id = id;}
 
-	Process(int type, ActorId id = -1);
+	Process(int type, ActorId id = INVALID_ACTOR_ID);
 	Process(const Process& in);
 	virtual ~Process();
 
@@ -0,0 +1,321 @@
+#include "ProjectileTable.h"
+#include "RunnerTable.h"
+
+// The flight pass uses SSE2 where the compiler targets it.
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define PROJECTILE_SSE2
+#include <emmintrin.h>
+#endif
+
+// How often in ms the actors take a step, speeds are given as steps.
+const int kStepMS = 10;
+
+// How close a projectile has to pass to its target to hit it.
+const float kHitRadius = 0.1f;
+
+// How long a projectile flies before it gives up on a target it can't catch.
+// That's long enough to cross a good way past any tower's range.
+const int kMaxFlightMS = 10000;
+
+// Moves the last entry of the array into the gap at i.
+template <class T>
+static void SwapPop(std::vector<T> &v, int i)
+{
+	v[i] = v.back();
+	v.pop_back();
+}
+
+// Adds a projectile at the location, fired by the owner at the target.
+void ProjectileTable::Add(ActorId id, ActorId owner, ActorId target, Vec3 loc, Vec3 targetLoc, int speed)
+{
+	Remove(id);
+	ActorId index = GetActorIndex(id);
+	if (index >= m_slots.size())
+		m_slots.resize(index + 1, -1);
+
+	m_slots[index] = m_id.size();
+	m_id.push_back(id);
+	m_x.push_back(loc.x);
+	m_y.push_back(loc.y);
+	m_z.push_back(loc.z);
+	m_velocityX.push_back(0);
+	m_velocityY.push_back(0);
+	m_velocityZ.push_back(0);
+	m_target.push_back(target);
+	m_targetX.push_back(targetLoc.x);
+	m_targetY.push_back(targetLoc.y);
+	m_targetZ.push_back(targetLoc.z);
+	m_targetVelocityX.push_back(0);
+	m_targetVelocityY.push_back(0);
+	m_targetVelocityZ.push_back(0);
+	m_owner.push_back(owner);
+	m_speed.push_back((float)(speed * 0.003) / kStepMS);
+	m_elapsed.push_back(0);
+	m_action.push_back(PA_NONE);
+	m_facing.push_back(-1);
+}
+
+// Takes the projectile out, moving the last one into its place. Returns
+// false if there is no projectile with the id.
+bool ProjectileTable::Remove(ActorId id)
+{
+	int i = Find(id);
+	if (i < 0)
+		return false;
+
+	m_slots[GetActorIndex(m_id.back())] = i;
+	m_slots[GetActorIndex(id)] = -1;
+
+	SwapPop(m_id, i);
+	SwapPop(m_x, i);
+	SwapPop(m_y, i);
+	SwapPop(m_z, i);
+	SwapPop(m_velocityX, i);
+	SwapPop(m_velocityY, i);
+	SwapPop(m_velocityZ, i);
+	SwapPop(m_target, i);
+	SwapPop(m_targetX, i);
+	SwapPop(m_targetY, i);
+	SwapPop(m_targetZ, i);
+	SwapPop(m_targetVelocityX, i);
+	SwapPop(m_targetVelocityY, i);
+	SwapPop(m_targetVelocityZ, i);
+	SwapPop(m_owner, i);
+	SwapPop(m_speed, i);
+	SwapPop(m_elapsed, i);
+	SwapPop(m_action, i);
+	SwapPop(m_facing, i);
+	return true;
+}
+
+// Removes every projectile.
+void ProjectileTable::Clear()
+{
+	while (!m_id.empty())
+		Remove(m_id.back());
+	m_slots.clear();
+}
+
+// Gets where the projectile with the id is in the arrays, -1 if there is none.
+int ProjectileTable::Find(ActorId id) const
+{
+	ActorId index = GetActorIndex(id);
+	if (index >= m_slots.size() || m_slots[index] < 0 || m_id[m_slots[index]] != id)
+		return -1;
+
+	return m_slots[index];
+}
+
+// Tells the projectile where its target is now and how far it goes in a ms.
+void ProjectileTable::SetTarget(int i, Vec3 loc, Vec3 velocity)
+{
+	m_targetX[i] = loc.x;
+	m_targetY[i] = loc.y;
+	m_targetZ[i] = loc.z;
+	m_targetVelocityX[i] = velocity.x;
+	m_targetVelocityY[i] = velocity.y;
+	m_targetVelocityZ[i] = velocity.z;
+}
+
+#ifdef PROJECTILE_SSE2
+// Picks a where the mask is set and b where it isn't.
+static inline __m128 Select(__m128 mask, __m128 a, __m128 b)
+{
+	return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+
+static inline __m128i Select(__m128i mask, __m128i a, __m128i b)
+{
+	return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+#endif
+
+// Flies every projectile for deltaMS and marks what each one needs done
+// afterwards in m_action.
+//
+// A projectile heads for where its target will be when they meet if the
+// target keeps going the way it is, which it can always reach when it's the
+// faster one, or else for where the target is now. It flies straight there,
+// waiting at that point if it gets there early. Rather than checking how
+// close it ends up, the step is swept against the target's own step over
+// the same time, so it hits if they come within kHitRadius anywhere along
+// the way and stops where they met. A projectile flying longer than
+// kMaxFlightMS misses. m_facing is set when the projectile should turn.
+//
+// Where SSE2 is there the projectiles are done four at a time, with every
+// branch of MoveOne worked out for all four and masked together, so the
+// results are the same as MoveOne's to the bit.
+void ProjectileTable::Move(int deltaMS)
+{
+	int count = m_id.size();
+	int i = 0;
+#ifdef PROJECTILE_SSE2
+	const __m128 dt = _mm_set1_ps((float)deltaMS);
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 one = _mm_set1_ps(1);
+	const __m128i ones = _mm_set1_epi32(-1);
+	const __m128 signBit = _mm_set1_ps(-0.0f);
+	for (; i + 4 <= count; i += 4)
+	{
+		__m128 x = _mm_loadu_ps(&m_x[i]);
+		__m128 y = _mm_loadu_ps(&m_y[i]);
+		__m128 z = _mm_loadu_ps(&m_z[i]);
+		__m128 dx = _mm_sub_ps(_mm_loadu_ps(&m_targetX[i]), x);
+		__m128 dy = _mm_sub_ps(_mm_loadu_ps(&m_targetY[i]), y);
+		__m128 dz = _mm_sub_ps(_mm_loadu_ps(&m_targetZ[i]), z);
+		__m128 vx = _mm_loadu_ps(&m_targetVelocityX[i]);
+		__m128 vy = _mm_loadu_ps(&m_targetVelocityY[i]);
+		__m128 vz = _mm_loadu_ps(&m_targetVelocityZ[i]);
+		__m128 speed = _mm_loadu_ps(&m_speed[i]);
+
+		// The time to meet, the lanes with no answer aim at the target itself.
+		__m128 a = _mm_sub_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(vx, vx), _mm_mul_ps(vy, vy)), _mm_mul_ps(vz, vz)), _mm_mul_ps(speed, speed));
+		__m128 b = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, vx), _mm_mul_ps(dy, vy)), _mm_mul_ps(dz, vz));
+		__m128 c = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+		__m128 root = _mm_sqrt_ps(_mm_sub_ps(_mm_mul_ps(b, b), _mm_mul_ps(a, c)));
+		__m128 t = _mm_div_ps(_mm_add_ps(b, root), _mm_sub_ps(zero, a));
+		t = _mm_and_ps(_mm_cmplt_ps(a, zero), t);
+
+		__m128 aimX = _mm_add_ps(dx, _mm_mul_ps(vx, t));
+		__m128 aimY = _mm_add_ps(dy, _mm_mul_ps(vy, t));
+		__m128 aimZ = _mm_add_ps(dz, _mm_mul_ps(vz, t));
+		__m128 length = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(aimX, aimX), _mm_mul_ps(aimY, aimY)), _mm_mul_ps(aimZ, aimZ)));
+		__m128 travel = _mm_mul_ps(speed, dt);
+		__m128 early = _mm_cmplt_ps(length, travel);
+		__m128 f = Select(early, one, _mm_div_ps(travel, length));
+		__m128 flying = Select(early, _mm_div_ps(length, speed), dt);
+		__m128 stepX = _mm_mul_ps(aimX, f);
+		__m128 stepY = _mm_mul_ps(aimY, f);
+		__m128 stepZ = _mm_mul_ps(aimZ, f);
+
+		// The step against the target's, as the closest the two come.
+		__m128 wx = _mm_sub_ps(stepX, _mm_mul_ps(vx, flying));
+		__m128 wy = _mm_sub_ps(stepY, _mm_mul_ps(vy, flying));
+		__m128 wz = _mm_sub_ps(stepZ, _mm_mul_ps(vz, flying));
+		__m128 ww = _mm_add_ps(_mm_add_ps(_mm_mul_ps(wx, wx), _mm_mul_ps(wy, wy)), _mm_mul_ps(wz, wz));
+		__m128 dw = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, wx), _mm_mul_ps(dy, wy)), _mm_mul_ps(dz, wz));
+		__m128 u = _mm_min_ps(_mm_max_ps(_mm_div_ps(dw, ww), zero), one);
+		u = _mm_and_ps(_mm_cmpgt_ps(ww, zero), u);
+		__m128 ex = _mm_sub_ps(_mm_mul_ps(wx, u), dx);
+		__m128 ey = _mm_sub_ps(_mm_mul_ps(wy, u), dy);
+		__m128 ez = _mm_sub_ps(_mm_mul_ps(wz, u), dz);
+		__m128 closest = _mm_add_ps(_mm_add_ps(_mm_mul_ps(ex, ex), _mm_mul_ps(ey, ey)), _mm_mul_ps(ez, ez));
+		__m128 hit = _mm_cmple_ps(closest, _mm_set1_ps(kHitRadius * kHitRadius));
+
+		f = Select(hit, u, one);
+		__m128 velocityX = _mm_mul_ps(stepX, f);
+		__m128 velocityY = _mm_mul_ps(stepY, f);
+		__m128 velocityZ = _mm_mul_ps(stepZ, f);
+		_mm_storeu_ps(&m_velocityX[i], velocityX);
+		_mm_storeu_ps(&m_velocityY[i], velocityY);
+		_mm_storeu_ps(&m_velocityZ[i], velocityZ);
+		_mm_storeu_ps(&m_x[i], _mm_add_ps(x, velocityX));
+		_mm_storeu_ps(&m_y[i], _mm_add_ps(y, velocityY));
+		_mm_storeu_ps(&m_z[i], _mm_add_ps(z, velocityZ));
+
+		__m128i elapsed = _mm_add_epi32(_mm_loadu_si128((__m128i *)&m_elapsed[i]), _mm_set1_epi32(deltaMS));
+		_mm_storeu_si128((__m128i *)&m_elapsed[i], elapsed);
+		__m128i hitMask = _mm_castps_si128(hit);
+		__m128i missed = _mm_andnot_si128(hitMask, _mm_cmpgt_epi32(elapsed, _mm_set1_epi32(kMaxFlightMS - 1)));
+		__m128i moved = _mm_andnot_si128(_mm_or_si128(hitMask, missed), ones);
+		__m128i action = _mm_and_si128(moved, _mm_set1_epi32(PA_MOVED));
+		action = _mm_or_si128(action, _mm_and_si128(hitMask, _mm_set1_epi32(PA_HIT)));
+		action = _mm_or_si128(action, _mm_and_si128(missed, _mm_set1_epi32(PA_MISSED)));
+		_mm_storeu_si128((__m128i *)&m_action[i], action);
+
+		// GetFacing on the way to where it's aiming.
+		__m128i xMajor = _mm_castps_si128(_mm_cmpge_ps(_mm_andnot_ps(signBit, aimX), _mm_andnot_ps(signBit, aimZ)));
+		__m128i towardsX = _mm_castps_si128(_mm_cmpgt_ps(aimX, zero));
+		__m128i towardsZ = _mm_castps_si128(_mm_cmpgt_ps(aimZ, zero));
+		__m128i faceX = _mm_sub_epi32(_mm_set1_epi32(3), _mm_and_si128(towardsX, _mm_set1_epi32(2)));
+		__m128i faceZ = _mm_sub_epi32(_mm_set1_epi32(2), _mm_and_si128(towardsZ, _mm_set1_epi32(2)));
+		__m128i turn = _mm_and_si128(moved, _mm_castps_si128(_mm_cmpgt_ps(length, _mm_set1_ps(0.9f))));
+		_mm_storeu_si128((__m128i *)&m_facing[i], Select(turn, Select(xMajor, faceX, faceZ), ones));
+	}
+#endif
+	for (; i < count; i++)
+		MoveOne(i, deltaMS);
+}
+
+// Flies one projectile, the plain version of Move for projectiles left over
+// from the groups of four or when there's no SSE2.
+void ProjectileTable::MoveOne(int i, int deltaMS)
+{
+	float dt = (float)deltaMS;
+	float dx = m_targetX[i] - m_x[i];
+	float dy = m_targetY[i] - m_y[i];
+	float dz = m_targetZ[i] - m_z[i];
+	float vx = m_targetVelocityX[i];
+	float vy = m_targetVelocityY[i];
+	float vz = m_targetVelocityZ[i];
+	float speed = m_speed[i];
+
+	// They meet at the first t where the target, d + v * t away, is as far
+	// as the projectile flies in t. When the projectile is the faster one
+	// there's always exactly one t after now.
+	float a = (vx * vx + vy * vy + vz * vz) - speed * speed;
+	float b = dx * vx + dy * vy + dz * vz;
+	float c = dx * dx + dy * dy + dz * dz;
+	float t = 0;
+	if (a < 0)
+	{
+		float root = sqrt(b * b - a * c);
+		t = (b + root) / -a;
+	}
+
+	float aimX = dx + vx * t;
+	float aimY = dy + vy * t;
+	float aimZ = dz + vz * t;
+	float length = sqrt(aimX * aimX + aimY * aimY + aimZ * aimZ);
+	float travel = speed * dt;
+	float f = 1;
+	float flying = dt;
+	if (length < travel)
+		flying = length / speed;
+	else
+		f = travel / length;
+	float stepX = aimX * f;
+	float stepY = aimY * f;
+	float stepZ = aimZ * f;
+
+	// Seen from the target the projectile goes from -d to w - d while it's
+	// flying, the closest that comes to the target is where it hits.
+	float wx = stepX - vx * flying;
+	float wy = stepY - vy * flying;
+	float wz = stepZ - vz * flying;
+	float ww = wx * wx + wy * wy + wz * wz;
+	float dw = dx * wx + dy * wy + dz * wz;
+	float u = 0;
+	if (ww > 0)
+	{
+		u = dw / ww;
+		u = u > 0 ? u : 0;
+		u = u < 1 ? u : 1;
+	}
+	float ex = wx * u - dx;
+	float ey = wy * u - dy;
+	float ez = wz * u - dz;
+	bool hit = ex * ex + ey * ey + ez * ez <= kHitRadius * kHitRadius;
+
+	f = hit ? u : 1;
+	m_velocityX[i] = stepX * f;
+	m_velocityY[i] = stepY * f;
+	m_velocityZ[i] = stepZ * f;
+	m_x[i] += m_velocityX[i];
+	m_y[i] += m_velocityY[i];
+	m_z[i] += m_velocityZ[i];
+
+	m_elapsed[i] += deltaMS;
+	m_facing[i] = -1;
+	if (hit)
+		m_action[i] = PA_HIT;
+	else
+	if (m_elapsed[i] >= kMaxFlightMS)
+		m_action[i] = PA_MISSED;
+	else
+	{
+		m_action[i] = PA_MOVED;
+		if (length > 0.9f)
+			m_facing[i] = GetFacing(aimX, aimZ);
+	}
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include "StdHeader.h"
+
+// What a projectile needs done after the flight pass.
+enum ProjectileAction
+{
+	PA_NONE,
+	PA_MOVED,
+	PA_HIT,
+	PA_MISSED
+};
+
+// The projectiles in flight, kept as one packed array per field the same
+// way as RunnerTable, so one pass moves every projectile and finds the ones
+// that hit. Projectiles fly straight for where their target will be, and a
+// hit is found anywhere along the step so it doesn't depend on how long the
+// updates are. Removing a projectile moves the last one into its slot, so the
+// slots of the ones that hit are used by the next ones fired. Projectiles
+// are looked up through m_slots by their id's index. Each one still has an
+// actor for the views to draw.
+class ProjectileTable
+{
+	std::vector<int>			m_slots;
+
+public:
+	std::vector<ActorId>		m_id;
+	std::vector<float>			m_x;
+	std::vector<float>			m_y;
+	std::vector<float>			m_z;
+
+	// The step the projectile took last, it's zero until it has moved.
+	std::vector<float>			m_velocityX;
+	std::vector<float>			m_velocityY;
+	std::vector<float>			m_velocityZ;
+
+	// The runner it's after, where that runner was last seen and how far it
+	// goes in a ms. Once the runner is gone the projectile still flies to
+	// where it was.
+	std::vector<ActorId>		m_target;
+	std::vector<float>			m_targetX;
+	std::vector<float>			m_targetY;
+	std::vector<float>			m_targetZ;
+	std::vector<float>			m_targetVelocityX;
+	std::vector<float>			m_targetVelocityY;
+	std::vector<float>			m_targetVelocityZ;
+
+	// The tower that fired it, which does the damage when it hits.
+	std::vector<ActorId>		m_owner;
+
+	// How far the projectile goes in a ms, and how long it has been flying.
+	std::vector<float>			m_speed;
+	std::vector<int>			m_elapsed;
+
+	// Filled in by Move for the pass that follows it. m_facing is the way the
+	// projectile should now face, or -1 to leave it.
+	std::vector<int>			m_action;
+	std::vector<int>			m_facing;
+
+	void Add(ActorId id, ActorId owner, ActorId target, Vec3 loc, Vec3 targetLoc, int speed);
+	bool Remove(ActorId id);
+	void Clear();
+	int Find(ActorId id) const;
+	int Count() const {return m_id.size();}
+	void SetTarget(int i, Vec3 loc, Vec3 velocity);
+	void StopTarget(int i) {m_targetVelocityX[i] = 0; m_targetVelocityY[i] = 0; m_targetVelocityZ[i] = 0;}
+	Vec3 GetLocation(int i) const {return Vec3(m_x[i], m_y[i], m_z[i]);}
+	void Move(int deltaMS);
+
+private:
+	void MoveOne(int i, int deltaMS);
+};
@@ -0,0 +1,281 @@
+#include "RunnerTable.h"
+
+// The movement pass uses SSE2 where the compiler targets it.
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define RUNNER_SSE2
+#include <emmintrin.h>
+#endif
+
+// How often in ms a runner takes a step, the same as the other actors.
+const int kStepMS = 10;
+
+// How far a runner with the speed goes in one step.
+static float StepLength(int speed)
+{
+	return (float)(speed * 0.003);
+}
+
+// Moves the last entry of the array into the gap at i.
+template <class T>
+static void SwapPop(std::vector<T> &v, int i)
+{
+	v[i] = v.back();
+	v.pop_back();
+}
+
+// Adds a runner at the location with nowhere to go yet.
+void RunnerTable::Add(ActorId id, Vec3 loc, int speed, int timeToStart)
+{
+	Remove(id);
+	ActorId index = GetActorIndex(id);
+	if (index >= m_slots.size())
+		m_slots.resize(index + 1, -1);
+
+	m_slots[index] = m_id.size();
+	m_id.push_back(id);
+	m_x.push_back(loc.x);
+	m_y.push_back(loc.y);
+	m_z.push_back(loc.z);
+	m_targetX.push_back(loc.x);
+	m_targetY.push_back(loc.y);
+	m_targetZ.push_back(loc.z);
+	m_hasTarget.push_back(0);
+	m_path.push_back(WaypointRing());
+	m_stepLength.push_back(StepLength(speed));
+	m_elapsed.push_back(0);
+	m_timeToStart.push_back(timeToStart);
+	m_buffs.push_back(0);
+	m_action.push_back(RA_NONE);
+	m_facing.push_back(-1);
+}
+
+// Takes the runner out, moving the last one into its place. Returns false
+// if there is no runner with the id.
+bool RunnerTable::Remove(ActorId id)
+{
+	int i = Find(id);
+	if (i < 0)
+		return false;
+
+	m_slots[GetActorIndex(m_id.back())] = i;
+	m_slots[GetActorIndex(id)] = -1;
+
+	SwapPop(m_id, i);
+	SwapPop(m_x, i);
+	SwapPop(m_y, i);
+	SwapPop(m_z, i);
+	SwapPop(m_targetX, i);
+	SwapPop(m_targetY, i);
+	SwapPop(m_targetZ, i);
+	SwapPop(m_hasTarget, i);
+	SwapPop(m_path, i);
+	SwapPop(m_stepLength, i);
+	SwapPop(m_elapsed, i);
+	SwapPop(m_timeToStart, i);
+	SwapPop(m_buffs, i);
+	SwapPop(m_action, i);
+	SwapPop(m_facing, i);
+	return true;
+}
+
+// Removes every runner.
+void RunnerTable::Clear()
+{
+	while (!m_id.empty())
+		Remove(m_id.back());
+	m_slots.clear();
+}
+
+// Gets where the runner with the id is in the arrays, -1 if there is none.
+int RunnerTable::Find(ActorId id) const
+{
+	ActorId index = GetActorIndex(id);
+	if (index >= m_slots.size() || m_slots[index] < 0 || m_id[m_slots[index]] != id)
+		return -1;
+
+	return m_slots[index];
+}
+
+// Puts the runner at the location.
+void RunnerTable::SetLocation(int i, Vec3 v)
+{
+	m_x[i] = v.x;
+	m_y[i] = v.y;
+	m_z[i] = v.z;
+}
+
+// Sends the runner towards the location.
+void RunnerTable::SetTarget(int i, Vec3 v)
+{
+	m_targetX[i] = v.x;
+	m_targetY[i] = v.y;
+	m_targetZ[i] = v.z;
+	m_hasTarget[i] = 1;
+}
+
+// Changes how fast the runner moves.
+void RunnerTable::SetSpeed(int i, int speed)
+{
+	m_stepLength[i] = StepLength(speed);
+}
+
+// Gets how far the runner goes in a ms on its way to its target, nothing if
+// it's waiting, has nowhere to go or is about to arrive.
+Vec3 RunnerTable::GetVelocity(int i) const
+{
+	if (m_timeToStart[i] > 0 || !m_hasTarget[i])
+		return Vec3(0, 0, 0);
+
+	Vec3 toTarget = GetTarget(i) - GetLocation(i);
+	float k = toTarget.Length();
+	if (k <= 0.1f)
+		return Vec3(0, 0, 0);
+
+	return toTarget * (m_stepLength[i] / kStepMS / k);
+}
+
+#ifdef RUNNER_SSE2
+// Picks a where the mask is set and b where it isn't.
+static inline __m128 Select(__m128 mask, __m128 a, __m128 b)
+{
+	return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+
+static inline __m128i Select(__m128i mask, __m128i a, __m128i b)
+{
+	return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+#endif
+
+// Steps every runner towards its target, the same way Actor::VOnUpdate moves
+// an actor, and marks what each one needs done afterwards in m_action. A
+// runner close enough to its target arrives instead of moving, and one with
+// no target is idle. m_facing is set when the runner should turn to face its
+// target.
+//
+// Where SSE2 is there the runners are done four at a time, with every branch
+// of MoveOne worked out for all four and masked together, so the results are
+// the same as MoveOne's to the bit.
+void RunnerTable::Move(int deltaMS)
+{
+	int count = m_id.size();
+	int i = 0;
+#ifdef RUNNER_SSE2
+	const __m128i delta = _mm_set1_epi32(deltaMS);
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i ones = _mm_set1_epi32(-1);
+	const __m128 signBit = _mm_set1_ps(-0.0f);
+	for (; i + 4 <= count; i += 4)
+	{
+		// Runners still waiting to start only count down.
+		__m128i timeToStart = _mm_loadu_si128((__m128i *)&m_timeToStart[i]);
+		__m128i waiting = _mm_cmpgt_epi32(timeToStart, zero);
+		_mm_storeu_si128((__m128i *)&m_timeToStart[i], _mm_sub_epi32(timeToStart, _mm_and_si128(waiting, delta)));
+
+		__m128i hasTarget = _mm_loadu_si128((__m128i *)&m_hasTarget[i]);
+		__m128i active = _mm_andnot_si128(waiting, _mm_cmpgt_epi32(hasTarget, zero));
+		__m128i idle = _mm_andnot_si128(_mm_or_si128(waiting, active), ones);
+
+		__m128i elapsed = _mm_loadu_si128((__m128i *)&m_elapsed[i]);
+		elapsed = _mm_andnot_si128(idle, _mm_add_epi32(elapsed, _mm_and_si128(active, delta)));
+		__m128i due = _mm_and_si128(active, _mm_cmpgt_epi32(elapsed, _mm_set1_epi32(kStepMS)));
+
+		__m128 x = _mm_loadu_ps(&m_x[i]);
+		__m128 y = _mm_loadu_ps(&m_y[i]);
+		__m128 z = _mm_loadu_ps(&m_z[i]);
+		__m128 targetX = _mm_loadu_ps(&m_targetX[i]);
+		__m128 targetY = _mm_loadu_ps(&m_targetY[i]);
+		__m128 targetZ = _mm_loadu_ps(&m_targetZ[i]);
+		__m128 dx = _mm_sub_ps(x, targetX);
+		__m128 dy = _mm_sub_ps(y, targetY);
+		__m128 dz = _mm_sub_ps(z, targetZ);
+		__m128 k = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz)));
+
+		__m128i far = _mm_castps_si128(_mm_cmpgt_ps(k, _mm_set1_ps(0.1f)));
+		__m128i moved = _mm_and_si128(due, far);
+		__m128i arrived = _mm_andnot_si128(far, due);
+
+		// The whole steps that have built up, the rest is kept for next time.
+		// Dividing in floats is exact for any elapsed time a runner can have.
+		__m128i steps = _mm_cvttps_epi32(_mm_div_ps(_mm_cvtepi32_ps(elapsed), _mm_set1_ps((float)kStepMS)));
+		__m128i stepsMS = _mm_add_epi32(_mm_slli_epi32(steps, 3), _mm_slli_epi32(steps, 1));
+		elapsed = Select(moved, _mm_sub_epi32(elapsed, stepsMS), _mm_andnot_si128(arrived, elapsed));
+		_mm_storeu_si128((__m128i *)&m_elapsed[i], elapsed);
+
+		__m128 d = _mm_div_ps(_mm_mul_ps(_mm_loadu_ps(&m_stepLength[i]), _mm_cvtepi32_ps(steps)), k);
+		d = _mm_min_ps(d, k);
+		__m128 move = _mm_castsi128_ps(moved);
+		_mm_storeu_ps(&m_x[i], Select(move, _mm_add_ps(x, _mm_mul_ps(_mm_sub_ps(targetX, x), d)), x));
+		_mm_storeu_ps(&m_y[i], Select(move, _mm_add_ps(y, _mm_mul_ps(_mm_sub_ps(targetY, y), d)), y));
+		_mm_storeu_ps(&m_z[i], Select(move, _mm_add_ps(z, _mm_mul_ps(_mm_sub_ps(targetZ, z), d)), z));
+		_mm_storeu_si128((__m128i *)&m_hasTarget[i], _mm_andnot_si128(arrived, hasTarget));
+
+		__m128i action = _mm_and_si128(moved, _mm_set1_epi32(RA_MOVED));
+		action = _mm_or_si128(action, _mm_and_si128(arrived, _mm_set1_epi32(RA_ARRIVED)));
+		action = _mm_or_si128(action, _mm_and_si128(idle, _mm_set1_epi32(RA_IDLE)));
+		_mm_storeu_si128((__m128i *)&m_action[i], action);
+
+		// GetFacing on the way to the target, which is the other way to dx and dz.
+		__m128i xMajor = _mm_castps_si128(_mm_cmpge_ps(_mm_andnot_ps(signBit, dx), _mm_andnot_ps(signBit, dz)));
+		__m128i towardsX = _mm_castps_si128(_mm_cmplt_ps(dx, _mm_setzero_ps()));
+		__m128i towardsZ = _mm_castps_si128(_mm_cmplt_ps(dz, _mm_setzero_ps()));
+		__m128i faceX = _mm_sub_epi32(_mm_set1_epi32(3), _mm_and_si128(towardsX, _mm_set1_epi32(2)));
+		__m128i faceZ = _mm_sub_epi32(_mm_set1_epi32(2), _mm_and_si128(towardsZ, _mm_set1_epi32(2)));
+		__m128i turn = _mm_and_si128(moved, _mm_castps_si128(_mm_cmpgt_ps(k, _mm_set1_ps(0.9f))));
+		_mm_storeu_si128((__m128i *)&m_facing[i], Select(turn, Select(xMajor, faceX, faceZ), ones));
+	}
+#endif
+	for (; i < count; i++)
+		MoveOne(i, deltaMS);
+}
+
+// Steps one runner, the plain version of Move for runners left over from
+// the groups of four or when there's no SSE2.
+void RunnerTable::MoveOne(int i, int deltaMS)
+{
+	m_action[i] = RA_NONE;
+	m_facing[i] = -1;
+
+	if (m_timeToStart[i] > 0)
+	{
+		m_timeToStart[i] -= deltaMS;
+		return;
+	}
+
+	if (!m_hasTarget[i])
+	{
+		m_elapsed[i] = 0;
+		m_action[i] = RA_IDLE;
+		return;
+	}
+
+	m_elapsed[i] += deltaMS;
+	if (m_elapsed[i] <= kStepMS)
+		return;
+
+	float dx = m_x[i] - m_targetX[i];
+	float dy = m_y[i] - m_targetY[i];
+	float dz = m_z[i] - m_targetZ[i];
+	float k = sqrt(dx * dx + dy * dy + dz * dz);
+	if (k > 0.1f)
+	{
+		int steps = m_elapsed[i] / kStepMS;
+		m_elapsed[i] -= steps * kStepMS;
+		float d = (m_stepLength[i] * steps) / k;
+		if (d > k)
+			d = k;
+
+		m_x[i] += (m_targetX[i] - m_x[i]) * d;
+		m_y[i] += (m_targetY[i] - m_y[i]) * d;
+		m_z[i] += (m_targetZ[i] - m_z[i]) * d;
+		m_action[i] = RA_MOVED;
+		if (k > 0.9f)
+			m_facing[i] = GetFacing(-dx, -dz);
+	}
+	else
+	{
+		m_hasTarget[i] = 0;
+		m_elapsed[i] = 0;
+		m_action[i] = RA_ARRIVED;
+	}
+}
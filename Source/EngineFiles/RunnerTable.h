@@ -0,0 +1,78 @@
+#pragma once
+
+#include "StdHeader.h"
+#include "WaypointRing.h"
+
+// What a runner needs done after the movement pass.
+enum RunnerAction
+{
+	RA_NONE,
+	RA_MOVED,
+	RA_ARRIVED,
+	RA_IDLE
+};
+
+// Gets which way an actor moving by dx, dz faces: 0 towards +z, 1 towards
+// +x, 2 towards -z and 3 towards -x. Whichever of dx and dz is bigger picks
+// the axis and its sign picks the side, so no angle is needed.
+inline int GetFacing(float dx, float dz)
+{
+	if (fabs(dx) >= fabs(dz))
+		return dx > 0 ? 1 : 3;
+
+	return dz > 0 ? 0 : 2;
+}
+
+// The runners' movement state, kept as one packed array per field so the
+// movement pass only reads what it needs from memory. Removing a runner
+// moves the last one into the gap, runners are looked up through m_slots
+// by their id's index. The runner actors still hold everything the views draw.
+class RunnerTable
+{
+	std::vector<int>			m_slots;
+
+public:
+	std::vector<ActorId>		m_id;
+	std::vector<float>			m_x;
+	std::vector<float>			m_y;
+	std::vector<float>			m_z;
+
+	// The square the runner is heading for, if m_hasTarget is set.
+	std::vector<float>			m_targetX;
+	std::vector<float>			m_targetY;
+	std::vector<float>			m_targetZ;
+	std::vector<int>			m_hasTarget;
+
+	// The squares the runner walks through next, the target is the first.
+	std::vector<WaypointRing>	m_path;
+
+	// How far the runner goes in one step.
+	std::vector<float>			m_stepLength;
+	std::vector<int>			m_elapsed;
+	std::vector<int>			m_timeToStart;
+
+	// A bit for each BuffType the runner has on it.
+	std::vector<unsigned int>	m_buffs;
+
+	// Filled in by Move for the pass that follows it.
+	// m_facing is the way the runner should now face, or -1 to leave it.
+	std::vector<int>			m_action;
+	std::vector<int>			m_facing;
+
+	void Add(ActorId id, Vec3 loc, int speed, int timeToStart);
+	bool Remove(ActorId id);
+	void Clear();
+	int Find(ActorId id) const;
+	int Count() const {return m_id.size();}
+	void SetLocation(int i, Vec3 v);
+	void SetTarget(int i, Vec3 v);
+	void SetSpeed(int i, int speed);
+	void ClearTarget(int i) {m_hasTarget[i] = 0;}
+	Vec3 GetLocation(int i) const {return Vec3(m_x[i], m_y[i], m_z[i]);}
+	Vec3 GetTarget(int i) const {return Vec3(m_targetX[i], m_targetY[i], m_targetZ[i]);}
+	Vec3 GetVelocity(int i) const;
+	void Move(int deltaMS);
+
+private:
+	void MoveOne(int i, int deltaMS);
+};
@@ -30,7 +30,7 @@ void SceneNodeProperties::Transform(Mat4x4 *toWorld, Mat4x4 *fromWorld) const
 
 SceneNode::SceneNode()
 {
-	m_props.m_ActorId = -1;
+	m_props.m_ActorId = INVALID_ACTOR_ID;
 	m_props.m_Name = "";
 	m_props.m_toWorld = m_props.m_fromWorld = Mat4x4::g_Identity;
 	m_props.m_Radius = 0;
@@ -251,17 +251,65 @@ HRESULT Scene::OnUpdate(const int deltaMilliseconds)
 	return m_Root->VOnUpdate(this, deltaMilliseconds);
 }
 
+// Copies what the game changed about each actor over to its scene node.
+// Called once a frame, so the nodes draw from their own copy in between.
+void Scene::SyncActors()
+{
+	for (SceneNodeList::iterator it = m_ActorNodes.begin(); it != m_ActorNodes.end(); it++)
+	{
+		if (!*it)
+			continue;
+
+		shared_ptr<IActor> actor = g_App->m_pGame->GetActor((*it)->VGet()->ActorId());
+		if (actor)
+			(*it)->VSyncActor(*actor->VGet());
+	}
+}
+
+// Moves the nodes of the actors the game moved, in one pass over the moves.
+// Moves are only ever to a new position, so the inverse is a translation
+// back rather than a full matrix inverse.
+void Scene::SyncTransforms(const TransformStream &moves)
+{
+	for (int i = 0; i < moves.Count(); i++)
+	{
+		ActorId id = moves.GetId(i);
+		ActorId index = GetActorIndex(id);
+		if (index >= m_ActorNodes.size() || !m_ActorNodes[index] || m_ActorNodes[index]->VGet()->ActorId() != id)
+			continue;
+
+		const Vec3 &pos = moves.GetPosition(i);
+		Mat4x4 toWorld, fromWorld;
+		toWorld.BuildTranslation(pos);
+		fromWorld.BuildTranslation(-pos.x, -pos.y, -pos.z);
+		m_ActorNodes[index]->VSetTransform(&toWorld, &fromWorld);
+	}
+}
+
 // Finds the scene node for the actor
 shared_ptr<ISceneNode> Scene::FindActor(ActorId id)
 {
-	SceneActorMap::iterator it = m_ActorMap.find(id);
-
-	if (it == m_ActorMap.end())
+	ActorId index = GetActorIndex(id);
+	if (index >= m_ActorNodes.size() || !m_ActorNodes[index] || m_ActorNodes[index]->VGet()->ActorId() != id)
 	{
 		shared_ptr<ISceneNode> node;
 		return node;
 	}
-	return (*it).second;
+	return m_ActorNodes[index];
+}
+
+// Adds a node to the scene, and keeps it to be found by the actor's id.
+// Nodes that aren't for an actor are added with INVALID_ACTOR_ID.
+bool Scene::AddChild(ActorId id, shared_ptr<ISceneNode> kid)
+{
+	if (id != INVALID_ACTOR_ID)
+	{
+		ActorId index = GetActorIndex(id);
+		if (index >= m_ActorNodes.size())
+			m_ActorNodes.resize(index + 1);
+		m_ActorNodes[index] = kid;
+	}
+	return m_Root->VAddChild(kid);
 }
 
 // Pushes the matrix onto the matrix stack for D3D
@@ -459,15 +507,15 @@ PlaneNode::PlaneNode():SceneNode()
 	m_pIndices = NULL;
 }
 
-PlaneNode::PlaneNode(shared_ptr<ActorParams> p):SceneNode(p->m_Id, "PlaneNode", NULL, RenderPass_Static, &p->m_Mat)
+PlaneNode::PlaneNode(const ActorRenderParams &p):SceneNode(p.m_Id, "PlaneNode", NULL, RenderPass_Static, &p.m_Mat)
 {
 	m_params = p;
-	m_props.SetHasAlpha(p->m_hasTextureAlpha);
-	m_bTextureHasAlpha = p->m_hasTextureAlpha;
+	m_props.SetHasAlpha(p.m_hasTextureAlpha);
+	m_bTextureHasAlpha = p.m_hasTextureAlpha;
 	m_pTexture = NULL;
 	m_pVerts = NULL;
 	m_pIndices = NULL;
-	if (p->m_Type != AT_GROUND)
+	if (p.m_Type != AT_GROUND)
 	{
 		m_props.SetRenderPass(RenderPass_Actor);
 	}
@@ -484,7 +532,7 @@ PlaneNode::~PlaneNode()
 
 HRESULT PlaneNode::VPreRender(Scene *pScene)
 {
-	pScene->PushAndSetMatrix(m_params->m_Mat);
+	pScene->PushAndSetMatrix(m_params.m_Mat);
 	return S_OK;
 }
 
@@ -498,7 +546,7 @@ HRESULT PlaneNode::VOnRestore(Scene *pScene)
 	SceneNode::VOnRestore(pScene);
 
 	// Get the texture from the resource file
-	Resource resource(m_params->m_Texture);
+	Resource resource(m_params.m_Texture);
 	int size = g_App->m_ResCache->Create(resource);
 
 	assert(size);
@@ -508,10 +556,10 @@ HRESULT PlaneNode::VOnRestore(Scene *pScene)
 				textureBuffer, resource.m_size, &m_pTexture) ) )
 		return E_FAIL;
 
-	SetRadius( sqrt(2.0f * m_params->m_Squares) );
+	SetRadius( sqrt(2.0f * m_params.m_Squares) );
 
 
-	m_numVerts = (m_params->m_Squares+1)*(m_params->m_Squares+1);
+	m_numVerts = (m_params.m_Squares+1)*(m_params.m_Squares+1);
 
 	if ( FAILED( DXUTGetD3DDevice ()->CreateVertexBuffer(m_numVerts*sizeof(COLORED_TEXTURED_VERTEX),
 		D3DUSAGE_WRITEONLY, COLORED_TEXTURED_VERTEX::FVF, D3DPOOL_MANAGED, &m_pVerts, NULL) ) )
@@ -523,35 +571,35 @@ HRESULT PlaneNode::VOnRestore(Scene *pScene)
 		return E_FAIL;
 
 	// Goes through the number of squares and makes that many planes.
-	for (DWORD j=0; j<(m_params->m_Squares+1); j++)
+	for (DWORD j=0; j<(m_params.m_Squares+1); j++)
 	{
-		for (DWORD i=0; i<(m_params->m_Squares+1); i++)
+		for (DWORD i=0; i<(m_params.m_Squares+1); i++)
 		{
-			int index = i + (j * (m_params->m_Squares+1));
+			int index = i + (j * (m_params.m_Squares+1));
 			COLORED_TEXTURED_VERTEX *vert = &pVertices[index];
 
-			float x = (float)i - (m_params->m_Squares/2.0f);
-			float y = (float)j - (m_params->m_Squares/2.0f);
+			float x = (float)i - (m_params.m_Squares/2.0f);
+			float y = (float)j - (m_params.m_Squares/2.0f);
 
-			vert->position = (x * Vec3(1,0,0) )* m_params->m_ActualWidth + (y * Vec3(0,0,1))*m_params->m_ActualHeight;
-			vert->color = m_params->m_Color;
+			vert->position = (x * Vec3(1,0,0) )* m_params.m_ActualWidth + (y * Vec3(0,0,1))*m_params.m_ActualHeight;
+			vert->color = m_params.m_Color;
 
-			if (m_params->m_Type == AT_GROUND)
+			if (m_params.m_Type == AT_GROUND)
 			{
 				vert->tu = x;
 				vert->tv = y;
 			}
 			else
 			{
-				vert->tu = (float)((i)  / (float)m_params->m_NumFrames);
-				vert->tv = (float)((1-j)  / (float)m_params->m_NumDirections);
+				vert->tu = (float)((i)  / (float)m_params.m_NumFrames);
+				vert->tv = (float)((1-j)  / (float)m_params.m_NumDirections);
 			}
 		}
 	}
 
 	m_pVerts->Unlock();
 
-	m_numPolys = m_params->m_Squares*m_params->m_Squares*2;
+	m_numPolys = m_params.m_Squares*m_params.m_Squares*2;
 
 	if ( FAILED( DXUTGetD3DDevice()->CreateIndexBuffer(sizeof(WORD) * m_numPolys * 3,
 				D3DUSAGE_WRITEONLY, D3DFMT_INDEX16, D3DPOOL_MANAGED, &m_pIndices, NULL) ) )
@@ -566,19 +614,19 @@ HRESULT PlaneNode::VOnRestore(Scene *pScene)
 	// C - D
 	
 	// Sets the indices
-	for (DWORD j=0; j<m_params->m_Squares; j++)
+	for (DWORD j=0; j<m_params.m_Squares; j++)
 	{
-		for (DWORD i=0; i<m_params->m_Squares; i++)
+		for (DWORD i=0; i<m_params.m_Squares; i++)
 		{
 			// Triangle #1 ACB
-			*(pIndices)   = WORD(i     + ( j   *(m_params->m_Squares+1)));
-			*(pIndices+1) = WORD(i     + ((j+1)*(m_params->m_Squares+1)));
-			*(pIndices+2) = WORD((i+1) + ( j   *(m_params->m_Squares+1)));
+			*(pIndices)   = WORD(i     + ( j   *(m_params.m_Squares+1)));
+			*(pIndices+1) = WORD(i     + ((j+1)*(m_params.m_Squares+1)));
+			*(pIndices+2) = WORD((i+1) + ( j   *(m_params.m_Squares+1)));
 
 			// Triangle #2 BCD
-			*(pIndices+3) = WORD((i+1) + (j    *(m_params->m_Squares+1)));
-			*(pIndices+4) = WORD(i     + ((j+1)*(m_params->m_Squares+1)));
-			*(pIndices+5) = WORD((i+1) + ((j+1)*(m_params->m_Squares+1)));
+			*(pIndices+3) = WORD((i+1) + (j    *(m_params.m_Squares+1)));
+			*(pIndices+4) = WORD(i     + ((j+1)*(m_params.m_Squares+1)));
+			*(pIndices+5) = WORD((i+1) + ((j+1)*(m_params.m_Squares+1)));
 			pIndices+=6;
 		}
 	}
@@ -623,7 +671,7 @@ HRESULT PlaneNode::VRender(Scene *pScene)
 	}
 
 	// Transforms the texture to where it needs to be.
-	DXUTGetD3DDevice()->SetTransform( D3DTS_TEXTURE0, &(m_params->m_TextureMat) ); 
+	DXUTGetD3DDevice()->SetTransform( D3DTS_TEXTURE0, &(m_params.m_TextureMat) ); 
 	DXUTGetD3DDevice()->SetStreamSource(0, m_pVerts, 0, sizeof(COLORED_TEXTURED_VERTEX) );
 	DXUTGetD3DDevice()->SetIndices(m_pIndices);
 	DXUTGetD3DDevice()->SetFVF( COLORED_TEXTURED_VERTEX::FVF );
@@ -639,40 +687,46 @@ HRESULT PlaneNode::VRender(Scene *pScene)
 	return S_OK;
 }
 
+// Takes the actor's position, direction and whether it's walking from the game.
+void PlaneNode::VSyncActor(const ActorParams &p)
+{
+	m_params.Sync(p);
+}
+
 // Update for plane nodes
 HRESULT PlaneNode::VOnUpdate(Scene *pScene, const DWORD elapsedMS)
 {
 	SceneNode::VOnUpdate(pScene, elapsedMS);
-	m_params->m_ElapsedTime += elapsedMS;
+	m_params.m_ElapsedTime += elapsedMS;
 
 	// Checks if the animation should move to the next frame.
-	if (m_params->m_ElapsedTime >= m_params->m_MSPerFrame)
+	if (m_params.m_ElapsedTime >= m_params.m_MSPerFrame)
 	{
-		DWORD const numFramesToAdvance = (m_params->m_ElapsedTime / m_params->m_MSPerFrame);
+		DWORD const numFramesToAdvance = (m_params.m_ElapsedTime / m_params.m_MSPerFrame);
 
-		m_params->m_ElapsedTime -= (numFramesToAdvance * m_params->m_MSPerFrame);
+		m_params.m_ElapsedTime -= (numFramesToAdvance * m_params.m_MSPerFrame);
 
-		int desiredFrame = m_params->m_Frame+ numFramesToAdvance;
+		int desiredFrame = m_params.m_Frame+ numFramesToAdvance;
 
-		if ( (false == m_params->m_LoopingAnim) && (desiredFrame >= m_params->m_NumFrames) )
+		if ( (false == m_params.m_LoopingAnim) && (desiredFrame >= m_params.m_NumFrames) )
 		{
-			desiredFrame = m_params->m_NumFrames - 1;
+			desiredFrame = m_params.m_NumFrames - 1;
 		}
 
-		if (desiredFrame % m_params->m_NumFrames == 0)
+		if (desiredFrame % m_params.m_NumFrames == 0)
 			desiredFrame = 1; 
 
-		if (!m_params->m_IsPaused)
+		if (!m_params.m_IsPaused)
 			desiredFrame = 0;
 
-		m_params->m_Frame = desiredFrame % m_params->m_NumFrames;
+		m_params.m_Frame = desiredFrame % m_params.m_NumFrames;
 	}
 
 	Mat4x4 trans = Mat4x4::g_Identity; // this is kind of nasty, probably shouldn't be changing the matrix like this
-	trans.m[2][0] = m_params->m_Frame / (float)m_params->m_NumFrames;
-	trans.m[2][1] = m_params->m_Direction / (float)m_params->m_NumDirections;
+	trans.m[2][0] = m_params.m_Frame / (float)m_params.m_NumFrames;
+	trans.m[2][1] = m_params.m_Direction / (float)m_params.m_NumDirections;
 
-	m_params->m_TextureMat = trans;
+	m_params.m_TextureMat = trans;
 
 	return S_OK;
 }
@@ -689,7 +743,7 @@ ShotNode::ShotNode():SceneNode(), m_elapsedTime(0)
 {
 }
 
-ShotNode::ShotNode(ActorId id, int time, unsigned int num, std::string texture, Mat4x4 start, Mat4x4 end):SceneNode(num, "ShotNode", NULL, RenderPass_Effect, &start),
+ShotNode::ShotNode(ActorId id, int time, unsigned int num, StringId texture, Mat4x4 start, Mat4x4 end):SceneNode(num, "ShotNode", NULL, RenderPass_Effect, &start),
 					m_shotNum(num),m_timeLeft(time),m_id(id),m_textureFile(texture),m_elapsedTime(0)
 {
 	Vec3 s = start.GetPosition();
@@ -886,7 +940,7 @@ LifeBarNode::LifeBarNode():SceneNode()
 	m_pIndices = NULL;
 }
 LifeBarNode::LifeBarNode(ActorId id, float startlife):SceneNode(-1, "ShotNode", NULL, RenderPass_Effect, &Mat4x4::g_Identity),
-					m_id(id),m_textureFile("lifebar.bmp"),m_TextureMat(),m_maxLife(startlife),m_fadeOutTime(1000),m_lastTime(0), m_curLife(startlife),m_alpha(0)
+					m_id(id),m_textureFile(InternString("lifebar.bmp")),m_TextureMat(),m_maxLife(startlife),m_fadeOutTime(1000),m_lastTime(0), m_curLife(startlife),m_alpha(0)
 {
 	Mat4x4 m;
 	m.BuildTranslation(g_Forward*0.5);
@@ -1082,7 +1136,7 @@ RangeNode::RangeNode():SceneNode()
 }
 
 RangeNode::RangeNode(float range):SceneNode(-1, "ShotNode", NULL, RenderPass_Effect, &Mat4x4::g_Identity),
-						m_textureFile("circle.dds"),m_TextureMat( Mat4x4::g_Identity),m_range(range)
+						m_textureFile(InternString("circle.dds")),m_TextureMat( Mat4x4::g_Identity),m_range(range)
 {
 	m_pTexture = NULL;
 	m_pVerts = NULL;
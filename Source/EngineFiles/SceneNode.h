@@ -2,6 +2,8 @@
 
 #include "StdHeader.h"
 
+class TransformStream;
+
 class SceneNodeProperties
 {
 	friend class SceneNode;
@@ -55,6 +57,7 @@ public:
 
 	virtual bool VAddChild(shared_ptr<ISceneNode> kid);
 	virtual bool VRemoveChild(ActorId id);	
+	virtual void VSyncActor(const ActorParams &p) {}
 	void SetRadius (const float radius) { m_props.m_Radius = radius;}
 };
 
@@ -103,7 +106,10 @@ protected:
 	shared_ptr<CameraNode>			m_Camera;
 	ID3DXMatrixStack				*m_MatrixStack;
 	AlphaSceneNodes					m_AlphaSceneNodes;
-	SceneActorMap					m_ActorMap;
+
+	// The actors' nodes by their id's index. A slot is empty or holds a
+	// node for an older id if the actor has no node.
+	SceneNodeList					m_ActorNodes;
 
 	void RenderAlphaPass();
 
@@ -114,19 +120,15 @@ public:
 	HRESULT OnRender();
 	HRESULT OnRestore();
 	HRESULT OnUpdate(const int deltaMilliseconds);
+	void SyncActors();
+	void SyncTransforms(const TransformStream &moves);
 
 	shared_ptr<ISceneNode> FindActor(ActorId id);
-	bool AddChild(ActorId id, shared_ptr<ISceneNode> kid)
-	{
-		if (id >= 0)
-		{
-			m_ActorMap[id] = kid;
-		}
-		return m_Root->VAddChild(kid);
-	}
+	bool AddChild(ActorId id, shared_ptr<ISceneNode> kid);
 	bool RemoveChild (ActorId id)
 	{ 
-		m_ActorMap.erase(id);
+		if (FindActor(id))
+			m_ActorNodes[GetActorIndex(id)].reset();
 		return m_Root->VRemoveChild(id); 
 	}
 	bool RemoveEffect (unsigned int num)
@@ -155,21 +157,22 @@ class PlaneNode : public SceneNode
 	LPDIRECT3DINDEXBUFFER9			m_pIndices;
 	DWORD							m_numVerts;
 	DWORD							m_numPolys;
-	shared_ptr<ActorParams>			m_params;
+	ActorRenderParams				m_params;
 
 public:
 	bool							m_bTextureHasAlpha;
 
 	PlaneNode();
-	PlaneNode(shared_ptr<ActorParams> p);
+	PlaneNode(const ActorRenderParams &p);
 	~PlaneNode();
 
 	virtual HRESULT VOnRestore(Scene *pScene);
 	virtual HRESULT VPreRender(Scene *pScene);
 	virtual HRESULT VRender(Scene *pScene);
 
-	void ChangeAnimationLoop (bool loop) {m_params->m_IsPaused = loop;}
-	void ChangeDirection(int dir) {m_params->m_Direction=dir; }
+	void ChangeAnimationLoop (bool loop) {m_params.m_IsPaused = loop;}
+	void ChangeDirection(int dir) {m_params.m_Direction=dir; }
+	virtual void VSyncActor(const ActorParams &p);
 	virtual HRESULT VOnUpdate(Scene *pScene, const DWORD elapsedMS);
 };
 
@@ -181,7 +184,7 @@ class LifeBarNode : public SceneNode
 	DWORD							m_numVerts;
 	DWORD							m_numPolys;
 	ActorId							m_id;
-	std::string						m_textureFile;
+	StringId						m_textureFile;
 	Mat4x4							m_TextureMat;
 	float							m_maxLife;	
 	DWORD							m_lastTime;
@@ -207,7 +210,7 @@ class RangeNode : public SceneNode
 	LPDIRECT3DINDEXBUFFER9			m_pIndices;
 	DWORD							m_numVerts;
 	DWORD							m_numPolys;
-	std::string						m_textureFile;
+	StringId						m_textureFile;
 	Mat4x4							m_TextureMat;
 	float							m_range;
 public:
@@ -229,7 +232,7 @@ class ShotNode : public SceneNode
 	DWORD							m_numPolys;
 	float							m_distance;
 	ActorId							m_id;
-	std::string						m_textureFile;
+	StringId						m_textureFile;
 	int								m_elapsedTime;
 	Mat4x4							m_TextureMat;
 public:
@@ -238,7 +241,7 @@ public:
 	int								m_timeLeft;
 
 	ShotNode();
-	ShotNode(ActorId id, int time, unsigned int num,std::string texture, Mat4x4 start, Mat4x4 end);
+	ShotNode(ActorId id, int time, unsigned int num, StringId texture, Mat4x4 start, Mat4x4 end);
 	~ShotNode();
 
 	virtual HRESULT VOnRestore(Scene *pScene);
@@ -29,7 +29,7 @@ bool CSoundResource::VInitialize()
 {
 	if (!m_Initialized)
 	{
-		m_SoundType = CAudio::FindSoundTypeFromFile(m_Resource.m_name.c_str());
+		m_SoundType = CAudio::FindSoundTypeFromFile(GetString(m_Resource.m_name).c_str());
 		
 		int m_PCMBufferSize = g_App->m_ResCache->Create(m_Resource);
 
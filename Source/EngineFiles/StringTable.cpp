@@ -0,0 +1,97 @@
+#include "StringTable.h"
+#include <deque>
+#include <vector>
+#include <string.h>
+
+// The interned strings, found by hash with open addressing. m_buckets holds
+// an id plus one, zero for an empty bucket, and is kept at most half full.
+// The strings are in a deque so GetString's references stay good as it grows.
+struct StringTable
+{
+	std::deque<std::string>		m_strings;
+	std::vector<unsigned int>	m_hashes;
+	std::vector<StringId>		m_buckets;
+
+	StringTable():m_buckets(64, 0) {Intern("", 0);}
+
+	StringId Intern(const char *s, size_t len);
+	void Grow();
+};
+
+// FNV-1a hash of the string.
+static unsigned int HashString(const char *s, size_t len)
+{
+	unsigned int hash = 2166136261u;
+	for (size_t i = 0; i < len; i++)
+	{
+		hash ^= (unsigned char)s[i];
+		hash *= 16777619u;
+	}
+	return hash;
+}
+
+// Gets the id for the string, adding it if it's new.
+StringId StringTable::Intern(const char *s, size_t len)
+{
+	unsigned int hash = HashString(s, len);
+	unsigned int mask = m_buckets.size() - 1;
+	for (unsigned int b = hash & mask;; b = (b + 1) & mask)
+	{
+		StringId entry = m_buckets[b];
+		if (entry == 0)
+		{
+			StringId id = m_strings.size();
+			m_strings.push_back(std::string(s, len));
+			m_hashes.push_back(hash);
+			m_buckets[b] = id + 1;
+			if (m_strings.size() * 2 > m_buckets.size())
+				Grow();
+
+			return id;
+		}
+
+		const std::string &str = m_strings[entry - 1];
+		if (m_hashes[entry - 1] == hash && str.size() == len && memcmp(str.data(), s, len) == 0)
+			return entry - 1;
+	}
+}
+
+// Doubles the buckets and puts every string back in.
+void StringTable::Grow()
+{
+	m_buckets.assign(m_buckets.size() * 2, 0);
+	unsigned int mask = m_buckets.size() - 1;
+	for (StringId id = 0; id < m_strings.size(); id++)
+	{
+		unsigned int b = m_hashes[id] & mask;
+		while (m_buckets[b] != 0)
+			b = (b + 1) & mask;
+		m_buckets[b] = id + 1;
+	}
+}
+
+// The table is made the first time it's used, since names get interned
+// while other globals are being built.
+static StringTable &GetTable()
+{
+	static StringTable table;
+	return table;
+}
+
+// Gets the id for the string, adding it to the table if it's new.
+StringId InternString(const char *s)
+{
+	return GetTable().Intern(s, strlen(s));
+}
+
+// Gets the id for the string, adding it to the table if it's new.
+StringId InternString(const std::string &s)
+{
+	return GetTable().Intern(s.data(), s.size());
+}
+
+// Gets the string an id was handed out for.
+const std::string &GetString(StringId id)
+{
+	return GetTable().m_strings[id];
+}
@@ -0,0 +1,13 @@
+#pragma once
+
+#include <string>
+
+// Names that get passed around a lot, textures, scripts and resources, are
+// interned once when they are read and handled by id after that. An id is
+// the same for the whole run, so comparing or copying a name is an int, and
+// the id for "" is 0.
+typedef unsigned int StringId;
+
+StringId InternString(const char *s);
+StringId InternString(const std::string &s);
+const std::string &GetString(StringId id);
@@ -0,0 +1,46 @@
+#include "TransformStream.h"
+
+// Puts the actor at the position in the back frame, over any move it has
+// already made this frame.
+void TransformStream::Publish(ActorId id, Vec3 pos)
+{
+	Frame &back = m_frames[m_back];
+	ActorId index = GetActorIndex(id);
+	if (index >= m_entries.size())
+		m_entries.resize(index + 1, -1);
+
+	int entry = m_entries[index];
+	if (entry >= 0 && back.m_ids[entry] == id)
+	{
+		back.m_positions[entry] = pos;
+		return;
+	}
+
+	m_entries[index] = back.m_ids.size();
+	back.m_ids.push_back(id);
+	back.m_positions.push_back(pos);
+}
+
+// Makes the back frame the one the views read and starts an empty one for
+// the game to fill.
+void TransformStream::Swap()
+{
+	Frame &back = m_frames[m_back];
+	for (unsigned int i = 0; i < back.m_ids.size(); i++)
+		m_entries[GetActorIndex(back.m_ids[i])] = -1;
+
+	m_back = 1 - m_back;
+	m_frames[m_back].m_ids.clear();
+	m_frames[m_back].m_positions.clear();
+}
+
+// Drops every move in both frames.
+void TransformStream::Clear()
+{
+	for (int f = 0; f < 2; f++)
+	{
+		m_frames[f].m_ids.clear();
+		m_frames[f].m_positions.clear();
+	}
+	m_entries.clear();
+}
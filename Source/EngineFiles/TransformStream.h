@@ -0,0 +1,40 @@
+#pragma once
+
+#include "StdHeader.h"
+
+// Where the actors that moved in a frame ended up, written by the game as it
+// moves them and read by the views in one pass, instead of an event for
+// every step. There are two frames of moves: the game fills the back one
+// while the views read the front one, and Swap hands the back one over at
+// the end of each game update. An actor that moves more than once in a frame
+// keeps one entry, found through m_entries by its id's index.
+//
+// Moves only change where an actor is, so only the position is kept.
+class TransformStream
+{
+	struct Frame
+	{
+		std::vector<ActorId>	m_ids;
+		std::vector<Vec3>		m_positions;
+	};
+
+	Frame					m_frames[2];
+	int						m_back;
+
+	// Where each actor index's entry is in the back frame, -1 if it has none.
+	std::vector<int>		m_entries;
+
+	const Frame &Front() const {return m_frames[1 - m_back];}
+
+public:
+	TransformStream():m_back(0) {}
+
+	void Publish(ActorId id, Vec3 pos);
+	void Swap();
+	void Clear();
+
+	// The moves in the front frame, in the order the actors first moved.
+	int Count() const {return Front().m_ids.size();}
+	ActorId GetId(int i) const {return Front().m_ids[i];}
+	const Vec3 &GetPosition(int i) const {return Front().m_positions[i];}
+};
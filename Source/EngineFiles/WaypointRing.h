@@ -0,0 +1,38 @@
+#pragma once
+
+// The next few squares an actor is to walk through, as a fixed-size ring of
+// map squares. The actor heads for Front and moves the cursor on with Pop
+// when it gets there, so following a path never allocates.
+struct WaypointRing
+{
+	enum { CAPACITY = 8 };
+
+	int				m_cells[CAPACITY];
+	unsigned char	m_head;
+	unsigned char	m_count;
+
+	WaypointRing():m_head(0),m_count(0) {}
+
+	bool Empty() const {return m_count == 0;}
+	bool Full() const {return m_count == CAPACITY;}
+	int Front() const {return m_cells[m_head];}
+	void Clear() {m_head = 0; m_count = 0;}
+
+	// Adds a square to the end of the path, returns false if there's no room.
+	bool Push(int cell)
+	{
+		if (Full())
+			return false;
+
+		m_cells[(m_head + m_count) % CAPACITY] = cell;
+		m_count++;
+		return true;
+	}
+
+	// Moves on to the next square.
+	void Pop()
+	{
+		m_head = (m_head + 1) % CAPACITY;
+		m_count--;
+	}
+};
@@ -28,6 +28,7 @@ char * const Evt_Change_Tower_Type::gkName = "change_tower_type";
 char * const Evt_New_Tower_Type::gkName = "new_tower_type_event";
 char * const Evt_RebuildUI::gkName = "rebuild_ui";
 char * const Evt_Damage_Actor::gkName = "damage_actor";
+char * const Evt_Damage_Area::gkName = "damage_area";
 char * const Evt_Apply_Buff::gkName = "apply_buff";
 char * const Evt_Create_Missile::gkName = "create_missile";
 char * const Evt_Left_Click::gkName = "right_click_event";
@@ -320,16 +320,16 @@ public:
 	Vec3 m_end;
 	ActorId m_id;
 	int m_time;
-	std::string m_texture;
+	StringId m_texture;
 
-	EvtData_Shot(ActorId id, int time, Vec3 start, Vec3 end, std::string texture):m_start(start), m_end(end), m_id(id), m_time(time), m_texture(texture){}
+	EvtData_Shot(ActorId id, int time, Vec3 start, Vec3 end, StringId texture):m_start(start), m_end(end), m_id(id), m_time(time), m_texture(texture){}
 };
 
 class Evt_Shot :public Event
 {
 public:
 	static char * const gkName;
-	Evt_Shot(ActorId id, int time, Vec3 start, Vec3 end, std::string texture):Event(gkName, 0, EventDataPtr(SAFE_NEW EvtData_Shot(id, time, start, end, texture))) {}
+	Evt_Shot(ActorId id, int time, Vec3 start, Vec3 end, StringId texture):Event(gkName, 0, EventDataPtr(SAFE_NEW EvtData_Shot(id, time, start, end, texture))) {}
 };
 
 
@@ -474,6 +474,25 @@ public:
 
 
 
+// Event used to deal damage to every runner within a radius of a location.
+class EvtData_Damage_Area : public IEventData
+{
+public:
+	Vec3 m_loc;
+	float m_radius;
+	int m_damage;
+	EvtData_Damage_Area(Vec3 loc, float radius, int damage): m_loc(loc),m_radius(radius),m_damage(damage){}
+};
+
+class Evt_Damage_Area : public Event
+{
+public:
+	static char * const gkName;
+	Evt_Damage_Area(Vec3 loc, float radius, int damage): Event(gkName, 0, EventDataPtr( SAFE_NEW EvtData_Damage_Area(loc, radius, damage))) {}
+};
+
+
+
 // Event used to apply a buff (or modifier) to a target.
 class EvtData_Apply_Buff : public IEventData
 {
@@ -1,5 +1,6 @@
 #pragma once
 #include "StdHeader.h"
+#include "EngineFiles/StringTable.h"
 
 class Resource;
 class IResourceFile
@@ -11,7 +12,19 @@ public:
 	virtual ~IResourceFile() { }
 };
 
+// An ActorId is a handle: the low bits are the actor's slot in the game's
+// actor table, the high bits how many times the slot has been reused. An id
+// kept after its actor is gone never finds the slot's next actor.
+// INVALID_ACTOR_ID stands for no actor, slot 0 is never handed out.
 typedef unsigned int ActorId;
+const int ACTOR_INDEX_BITS = 20;
+const ActorId ACTOR_INDEX_MASK = (1 << ACTOR_INDEX_BITS) - 1;
+const ActorId ACTOR_GENERATION_MAX = ~(ActorId)0 >> ACTOR_INDEX_BITS;
+const ActorId INVALID_ACTOR_ID = 0;
+
+inline ActorId GetActorIndex(ActorId id) {return id & ACTOR_INDEX_MASK;}
+inline ActorId GetActorGeneration(ActorId id) {return id >> ACTOR_INDEX_BITS;}
+inline ActorId MakeActorId(ActorId index, ActorId generation) {return (generation << ACTOR_INDEX_BITS) | index;}
 
 enum ActorType
 {
@@ -20,7 +33,8 @@ enum ActorType
 	AT_TOWER,
 	AT_EFFECT,
 	AT_MISSILE,
-	AT_RUNNER
+	AT_RUNNER,
+	AT_COUNT
 };
 
 enum RenderPass
@@ -43,18 +57,39 @@ enum GameStatus
 	Game_Last
 };
 
+// What the game knows about an actor, everything the simulation reads or
+// changes as it runs. How the actor is drawn is kept in ActorRenderParams.
 struct ActorParams
 {
-	int					m_Size;
+	ActorId				m_Id;
+	ActorType			m_Type;
+	float				m_life;
+	int					m_speed;
+	int					m_cost;
+	float				m_radius;
+	float				m_ActualWidth;
+	float				m_ActualHeight;
+	int					m_Direction;
+	bool				m_LoopingAnim;
+	Mat4x4				m_Mat;
+
+	ActorParams():m_Id(0),m_Type(AT_UNKNOWN),m_life(0),m_speed(0),m_cost(0),m_radius(0),m_ActualWidth(1),m_ActualHeight(1),
+		m_Direction(0),m_LoopingAnim(false) { m_Mat=Mat4x4::g_Identity; }
+};
+
+// How an actor is drawn. Each view keeps its own copy, so nothing the views
+// do touches the game's ActorParams, and the parts the game changes are
+// copied over once a frame with Sync.
+struct ActorRenderParams
+{
 	ActorId				m_Id;
 	ActorType			m_Type;
 	float				m_Width;
 	float				m_Height;
 	float				m_ActualWidth;
 	float				m_ActualHeight;
-	float				m_radius;
 	Color				m_Color;
-	std::string			m_Texture;
+	StringId			m_Texture;
 	Mat4x4				m_Mat;
 	Mat4x4				m_TextureMat;
 	int					m_Frame, m_NumFrames;
@@ -65,14 +100,23 @@ struct ActorParams
 	int					m_ElapsedTime;
 	int					m_MSPerFrame; // miliseconds per frame (1000 / desired frames per second)
 	unsigned int		m_Squares;
-	float				m_life;
-	int					m_cost;
-	int					m_speed;
 
-	ActorParams():m_ElapsedTime(0),m_MSPerFrame(1000) 
-		{ m_Mat=Mat4x4::g_Identity; m_TextureMat=Mat4x4::g_Identity; m_Type=AT_UNKNOWN; m_Size=sizeof(ActorParams);}
+	ActorRenderParams():m_Id(0),m_Type(AT_UNKNOWN),m_Texture(0),m_Frame(0),m_NumFrames(1),m_NumDirections(1),m_IsPaused(false),
+		m_hasTextureAlpha(false),m_ElapsedTime(0),m_MSPerFrame(1000),m_Squares(1)
+		{ m_Mat=Mat4x4::g_Identity; m_TextureMat=Mat4x4::g_Identity; }
 
-	int GetSize() { return m_Size; }
+	// Copies over what the game changes about the actor while it runs.
+	void Sync(const ActorParams &p) { m_Mat=p.m_Mat; m_Direction=p.m_Direction; m_LoopingAnim=p.m_LoopingAnim; }
+};
+
+// How a tower picks which of the runners in range to shoot.
+enum TargetPolicy
+{
+	TP_CLOSEST,
+	TP_FIRST,
+	TP_LAST,
+	TP_STRONGEST,
+	TP_COUNT
 };
 
 struct TowerParams
@@ -84,12 +128,14 @@ struct TowerParams
 	int m_reloadTime;
 	int m_nextUpgrade;
 	int m_maxUpgrade;
-	std::string m_script;
-	std::string m_shottexture;
-	std::string m_chartexture;
+	int m_targeting;
+	StringId m_script;
+	StringId m_shottexture;
+	StringId m_chartexture;
 
 	TowerParams(int type=0, int range=2, int cost=2, int damage=1, int reloadTime=1000): m_type(type), m_range(range),m_cost(cost),
-		m_damage(damage),m_reloadTime(reloadTime),m_shottexture("blue.bmp"),m_chartexture("character1.dds"),m_nextUpgrade(0),m_maxUpgrade(5) {}
+		m_damage(damage),m_reloadTime(reloadTime),m_nextUpgrade(0),m_maxUpgrade(5),m_targeting(TP_CLOSEST),
+		m_script(0),m_shottexture(InternString("blue.bmp")),m_chartexture(InternString("character1.dds")) {}
 };
 
 struct Upgrade
@@ -110,17 +156,19 @@ struct TowerType
 	int m_cost;
 	int m_damage;
 	int m_reloadTime;
-	std::string m_script;
-	std::string m_shottexture;
-	std::string m_chartexture;
+	int m_targeting;
+	StringId m_script;
+	StringId m_shottexture;
+	StringId m_chartexture;
 	Upgrade m_upgrades[5];
 
 	TowerType(int range=2, int cost=2, int damage=1, int reloadTime=1000): m_range(range),m_cost(cost),
-		m_damage(damage),m_reloadTime(reloadTime),m_shottexture("blue.bmp"),m_chartexture("character1.dds") {}
+		m_damage(damage),m_reloadTime(reloadTime),m_targeting(TP_CLOSEST),m_script(0),m_shottexture(InternString("blue.bmp")),m_chartexture(InternString("character1.dds")) {}
 	TowerParams GetParams() 
 	{
 		TowerParams p(m_type,m_range, m_cost, m_damage, m_reloadTime);
 		p.m_script = m_script;
+		p.m_targeting = m_targeting;
 		p.m_shottexture = m_shottexture;
 		p.m_chartexture = m_chartexture;
 		return p;
@@ -159,9 +207,9 @@ public:
 	virtual void VOnUpdate(int deltaMS)=0;
 	virtual float VGetRadius()=0;
 	virtual shared_ptr<ActorParams> VGet()=0;
+	virtual const ActorRenderParams &VGetRenderParams()=0;
+	virtual void VSetRenderParams(const ActorRenderParams &r)=0;
 	virtual void VSetId(ActorId id)=0;
-	virtual void VQueuePosition(const Mat4x4 &m)=0;
-	virtual void VClearQueue()=0;
 	virtual bool VTakeDamage(int damage)=0;
 	virtual void VSetDirection(Vec3 b)=0;
 	virtual void VApplyBuff(shared_ptr<IBuff> buff)=0;
@@ -204,7 +252,6 @@ public:
 	virtual void VAddActor(shared_ptr<IActor> actor)=0;
 	virtual void VRemoveActor(ActorId id)=0;
 	virtual void VGameStatusChange(GameStatus status)=0;
-	virtual void VMoveActor(ActorId id, Mat4x4 const &m)=0;
 	virtual void VRenderText(CDXUTTextHelper &txtHelper)=0;
 };
 
@@ -279,6 +326,7 @@ public:
 
 	virtual bool VAddChild(shared_ptr<ISceneNode> kid)=0;
 	virtual bool VRemoveChild(ActorId id)=0;
+	virtual void VSyncActor(const ActorParams &p)=0;
 
 	virtual ~ISceneNode() {};
 
@@ -296,7 +344,6 @@ struct AlphaSceneNode
 };
 
 typedef std::list<AlphaSceneNode> AlphaSceneNodes;
-typedef std::map<ActorId, shared_ptr<ISceneNode> > SceneActorMap;
 
 
 class IEventData
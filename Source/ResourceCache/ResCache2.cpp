@@ -40,7 +40,12 @@
 #include <list>
 #include <map>
 
+#include <stdio.h>
+
 #include "ResCache2.h"
+
+#ifndef TOWERSIM_HEADLESS
+
 #include "ZipFile.h"
 
 #pragma comment(lib, "zlib.lib")
@@ -63,7 +68,7 @@ bool ResourceZipFile::VOpen()
 int ResourceZipFile::VGetResourceSize(const Resource &r)
 {
 	int size = 0;
-	int resourceNum = m_pZipFile->Find(r.m_name.c_str());
+	int resourceNum = m_pZipFile->Find(r.m_name);
 	if (resourceNum>=0)
 	{
 		size = m_pZipFile->GetFileLen(resourceNum);
@@ -74,7 +79,7 @@ int ResourceZipFile::VGetResourceSize(const Resource &r)
 int ResourceZipFile::VGetResource(const Resource &r, char *buffer)
 {
 	int size = 0;
-	int resourceNum = m_pZipFile->Find(r.m_name.c_str());
+	int resourceNum = m_pZipFile->Find(r.m_name);
 	if (resourceNum>=0)
 	{
 		size = m_pZipFile->GetFileLen(resourceNum);
@@ -83,6 +88,33 @@ int ResourceZipFile::VGetResource(const Resource &r, char *buffer)
 	return 0;	
 }
 
+#endif
+
+int ResourceDirectory::VGetResourceSize(const Resource &r)
+{
+	FILE *f = fopen(GetPath(r).c_str(), "rb");
+	if (!f)
+		return 0;
+
+	fseek(f, 0, SEEK_END);
+	int size = (int)ftell(f);
+	fclose(f);
+	return size;
+}
+
+int ResourceDirectory::VGetResource(const Resource &r, char *buffer)
+{
+	FILE *f = fopen(GetPath(r).c_str(), "rb");
+	if (!f)
+		return 0;
+
+	fseek(f, 0, SEEK_END);
+	int size = (int)ftell(f);
+	fseek(f, 0, SEEK_SET);
+	size = (int)fread(buffer, 1, size, f);
+	fclose(f);
+	return size;
+}
 
 
 ResHandle::ResHandle(const Resource & resource, const char *buffer)
@@ -42,13 +42,16 @@
 class Resource
 {
 public:
-	std::string m_name;
+	StringId m_name;
 	unsigned int m_size;
 
-	Resource(std::string name) { m_name=name; m_size=0; }
+	Resource(StringId name) { m_name=name; m_size=0; }
+	Resource(const std::string &name) { m_name=InternString(name); m_size=0; }
 };
 
 
+#ifndef TOWERSIM_HEADLESS
+
 class CZipFile;
 
 class ResourceZipFile : public IResourceFile
@@ -65,6 +68,24 @@ public:
 	virtual int VGetResource(const Resource &r, char *buffer);
 };
 
+#endif
+
+// Reads resources as loose files from a directory, for builds without the zip file.
+class ResourceDirectory : public IResourceFile
+{
+	std::string m_dir;
+
+	std::string GetPath(const Resource &r) { return m_dir + "/" + GetString(r.m_name); }
+
+public:
+	ResourceDirectory(const std::string &dir) { m_dir = dir; }
+	virtual ~ResourceDirectory() { }
+
+	virtual bool VOpen() { return true; }
+	virtual int VGetResourceSize(const Resource &r);
+	virtual int VGetResource(const Resource &r, char *buffer);
+};
+
 
 class ResHandle
 {
@@ -81,7 +102,7 @@ public:
 
 
 typedef std::list<ResHandle *> ResHandleList;			// lru list
-typedef std::map<std::string, ResHandle *> ResHandleMap;		// maps indentifiers to resource data
+typedef std::map<StringId, ResHandle *> ResHandleMap;		// maps indentifiers to resource data
 
 class ResCache
 {
@@ -192,8 +192,7 @@ bool CZipFile::Init(const _TCHAR *resFileName)
 	  memcpy(fileName, pfh, fh.fnameLen);
 	  fileName[fh.fnameLen]=0;
 	  _strlwr(fileName);
-	  std::string spath = fileName;
-	  m_ZipContentsMap[spath] = i;
+	  m_ZipContentsMap[InternString(fileName)] = i;
 
       // Skip name, extra and comment fields.
       pfh += fh.fnameLen + fh.xtraLen + fh.cmntLen;
@@ -211,14 +210,19 @@ bool CZipFile::Init(const _TCHAR *resFileName)
   return success;
 }
 
-int CZipFile::Find(const char *path) const
+int CZipFile::Find(StringId path) const
 {
-	char lwrPath[_MAX_PATH];
-	strcpy(lwrPath, path);
-	_strlwr(lwrPath);
-	ZipContentsMap::const_iterator i = m_ZipContentsMap.find(lwrPath);
+	ZipContentsMap::const_iterator i = m_ZipContentsMap.find(path);
 	if (i==m_ZipContentsMap.end())
-		return -1;
+	{
+		// The paths are kept in lower case, so try that if the name wasn't.
+		char lwrPath[_MAX_PATH];
+		strcpy(lwrPath, GetString(path).c_str());
+		_strlwr(lwrPath);
+		i = m_ZipContentsMap.find(InternString(lwrPath));
+		if (i==m_ZipContentsMap.end())
+			return -1;
+	}
 
 	return (*i).second;
 }
@@ -43,7 +43,7 @@
 
 #include <stdio.h>
 
-typedef std::map<std::string, int> ZipContentsMap;		// maps path to a zip content id
+typedef std::map<StringId, int> ZipContentsMap;		// maps path to a zip content id
 
 class CZipFile
 {
@@ -58,7 +58,7 @@ class CZipFile
     void GetFilename(int i, char *pszDest) const;
     int GetFileLen(int i) const;
     bool ReadFile(int i, char *pBuf);
-	int Find(const char *path) const;
+	int Find(StringId path) const;
 
 	ZipContentsMap m_ZipContentsMap;
 
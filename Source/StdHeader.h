@@ -1,5 +1,12 @@
 #pragma once
 
+#ifdef TOWERSIM_HEADLESS
+
+// The headless simulation is built without Windows, DXUT or Direct3D.
+#include "TowerSim/SimPlatform.h"
+
+#else
+
 #define WIN32_LEAN_AND_MEAN
 
 #include <windows.h>
@@ -10,6 +17,7 @@
 #include <list>
 #include <queue>
 #include <map>
+#include <algorithm>
 #include <tchar.h>
 
 #if defined (_MSC_VER) && (_MSC_VER < 1300)
@@ -34,8 +42,10 @@
 #include <dxstdafx.h>
 #include <d3dx9tex.h>
 
-#include <boost\config.hpp>
-#include <boost\shared_ptr.hpp>
+#endif
+
+#include <boost/config.hpp>
+#include <boost/shared_ptr.hpp>
 
 using boost::shared_ptr;
 
@@ -47,12 +57,21 @@ struct AppMsg
 	LPARAM m_lParam;
 };
 
+#ifdef TOWERSIM_HEADLESS
+
+#include "TowerSim/SimGeometry.h"
+
+#else
+
 typedef D3DXCOLOR Color;
 
 #pragma warning( disable : 4244 ) 
 #pragma warning( disable : 4996 )
 
 #include "geometry.h"
+
+#endif
+
 #include "Interfaces.h"
 
 #define SCREEN_WIDTH 800
@@ -0,0 +1,234 @@
+/*
+movebench: times RunnerTable::Move against moving the runners one actor at a
+time, the way Actor::VOnUpdate moves them.
+
+Runners start at random places on the map, some of them waiting to start,
+and head for random squares. A runner that arrives or has nowhere to go is
+given a new square, the same one on both sides. Every tick both sides have to
+agree on where each runner is and what happened to it, to the bit. The way
+each runner faces is checked against the old angle based facing too, except
+close to the diagonals where the old one's rounded edges can pick either.
+
+	movebench [-runners n] [-ticks n] [-size n]
+*/
+
+#include "StdHeader.h"
+#include "EngineFiles/RunnerTable.h"
+#include <stdio.h>
+
+// How long a tick is in ms.
+const int kTickMS = 16;
+
+// Seconds from a steady clock.
+static double Now()
+{
+	timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return now.tv_sec + now.tv_nsec * 1e-9;
+}
+
+// A random number from lo to hi.
+static float Random(float lo, float hi)
+{
+	return lo + (hi - lo) * (rand() / (float)RAND_MAX);
+}
+
+// A runner moved the old way, one virtual call at a time.
+class BenchActor
+{
+public:
+	Mat4x4		m_Mat;
+	Vec3		m_target;
+	bool		m_hasTarget;
+	int			m_speed, m_elapsed, m_timeToStart;
+	int			m_direction, m_action;
+
+	BenchActor():m_hasTarget(false),m_speed(0),m_elapsed(0),m_timeToStart(0),m_direction(-1),m_action(RA_NONE) {m_Mat = Mat4x4::g_Identity;}
+	virtual ~BenchActor() {}
+
+	// Moves the actor like Actor::VOnUpdate.
+	virtual void VOnUpdate(int deltaMS)
+	{
+		m_action = RA_NONE;
+		if (m_timeToStart > 0)
+		{
+			m_timeToStart -= deltaMS;
+			return;
+		}
+
+		if (!m_hasTarget)
+		{
+			m_elapsed = 0;
+			m_action = RA_IDLE;
+			return;
+		}
+
+		m_elapsed += deltaMS;
+		if (m_elapsed <= 10)
+			return;
+
+		Vec3 A = m_Mat.GetPosition();
+		float k = A.Distance(m_target);
+		if (k > 0.1f)
+		{
+			if (k > 0.9f)
+				VSetDirection(m_target);
+
+			float distanceToMove = m_elapsed / 10;
+			m_elapsed -= distanceToMove * 10;
+			float speed = m_speed * 0.003;
+			float d = (speed * distanceToMove) / k;
+			if (d > k)
+				d = k;
+
+			Mat4x4 moveTo = Mat4x4::g_Identity;
+			moveTo.SetPosition(A + (m_target - A) * d);
+			m_Mat = moveTo;
+			m_action = RA_MOVED;
+		}
+		else
+		{
+			m_hasTarget = false;
+			m_elapsed = 0;
+			m_action = RA_ARRIVED;
+		}
+	}
+
+	// Faces the actor towards B with atan2, the way Actor::VSetDirection did.
+	virtual void VSetDirection(Vec3 B)
+	{
+		Vec3 A = m_Mat.GetPosition();
+		float direction = atan2(B.z - A.z, B.x - A.x);
+		if (direction < 0)
+			direction =  2*3.1415 + direction;
+
+		if (direction > 0 && direction < 0.785375)
+			m_direction = 1;
+		else
+		if (direction > 0.785375 && direction < 2.356125)
+			m_direction = 0;
+		else
+		if (direction > 2.356125 && direction < 3.926875)
+			m_direction = 3;
+		else
+		if (direction > 3.926875 && direction < 5.497625)
+			m_direction = 2;
+		else
+		if (direction > 5.497625)
+			m_direction = 1;
+	}
+};
+
+// The middle of a random square on the map.
+static Vec3 RandomSquare(int size)
+{
+	float half = size / 2.0f;
+	return Vec3(floor(Random(-half, half)) + 0.5f, 0, floor(Random(-half, half)) + 0.5f);
+}
+
+int main(int argc, char *argv[])
+{
+	int runners = 100000;
+	int ticks = 100;
+	int size = 64;
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "-runners") == 0 && i + 1 < argc)
+			runners = max(1, atoi(argv[++i]));
+		else
+		if (strcmp(argv[i], "-ticks") == 0 && i + 1 < argc)
+			ticks = max(1, atoi(argv[++i]));
+		else
+		if (strcmp(argv[i], "-size") == 0 && i + 1 < argc)
+			size = max(4, atoi(argv[++i]));
+		else
+		{
+			printf("usage: movebench [-runners n] [-ticks n] [-size n]\n");
+			return 1;
+		}
+	}
+
+	srand(1);
+	float half = size / 2.0f;
+
+	// Runner ids are their index plus one, and nothing is removed, so both
+	// sides keep the runners in the same order.
+	RunnerTable table;
+	std::vector<BenchActor *> actors(runners);
+	for (int i = 0; i < runners; i++)
+	{
+		Vec3 loc(Random(-half, half), 0, Random(-half, half));
+		int speed = rand() % 8 + 1;
+		int timeToStart = rand() % 4 == 0 ? rand() % 2000 : 0;
+
+		BenchActor *actor = new BenchActor;
+		actor->m_Mat.SetPosition(loc);
+		actor->m_speed = speed;
+		actor->m_timeToStart = timeToStart;
+		actors[i] = actor;
+		table.Add(i + 1, loc, speed, timeToStart);
+	}
+
+	double eachTime = 0, batchTime = 0;
+	int moved = 0, facings = 0, facingsChecked = 0;
+	bool agree = true;
+	for (int t = 0; t < ticks; t++)
+	{
+		for (int i = 0; i < runners; i++)
+		{
+			if (actors[i]->m_hasTarget)
+				continue;
+
+			Vec3 target = RandomSquare(size);
+			actors[i]->m_target = target;
+			actors[i]->m_hasTarget = true;
+			table.SetTarget(i, target);
+		}
+
+		double start = Now();
+		for (int i = 0; i < runners; i++)
+			actors[i]->VOnUpdate(kTickMS);
+		eachTime += Now() - start;
+
+		start = Now();
+		table.Move(kTickMS);
+		batchTime += Now() - start;
+
+		for (int i = 0; i < runners; i++)
+		{
+			const BenchActor *actor = actors[i];
+			Vec3 loc = actor->m_Mat.GetPosition();
+			if (loc.x != table.m_x[i] || loc.y != table.m_y[i] || loc.z != table.m_z[i] ||
+				actor->m_action != table.m_action[i] || actor->m_elapsed != table.m_elapsed[i] ||
+				actor->m_timeToStart != table.m_timeToStart[i] || actor->m_hasTarget != (table.m_hasTarget[i] != 0))
+				agree = false;
+
+			if (table.m_action[i] == RA_MOVED)
+				moved++;
+
+			if (table.m_facing[i] < 0)
+				continue;
+
+			facings++;
+			float dx = fabs(actor->m_target.x - table.m_x[i]);
+			float dz = fabs(actor->m_target.z - table.m_z[i]);
+			if (fabs(dx - dz) < 0.01f * (dx + dz))
+				continue;
+
+			facingsChecked++;
+			if (table.m_facing[i] != actor->m_direction)
+				agree = false;
+		}
+	}
+
+	printf("%d runners, %d ticks of %d ms, %.1f moved a tick, %d of %d turns checked\n",
+		runners, ticks, kTickMS, moved / (float)ticks, facingsChecked, facings);
+	printf("per actor      %9.1f us a tick\n", eachTime / ticks * 1e6);
+	printf("batched        %9.1f us a tick  speedup %6.1fx\n", batchTime / ticks * 1e6, eachTime / batchTime);
+	printf("%s\n", agree ? "agree" : "DISAGREE");
+
+	for (int i = 0; i < runners; i++)
+		delete actors[i];
+
+	return agree ? 0 : 1;
+}
@@ -0,0 +1,688 @@
+/*
+pathbench: times the heap based A* Map::TestLocation ran against the std::map
+based A* it replaced. The game now paths with the flow field and no longer
+searches square by square, so the heap search lives here, as the shortest
+path the flow field, the placement table and the clustered search are all
+checked against. The bench only uses Map's public functions, and keeps its
+own copy of the grid for its searches.
+
+Each grid is searched from the start square to the end square, then once from
+every open square to the end (the same work FindNewPaths does for a field full
+of runners, spread evenly over at most kMaxStarts squares on big maps). From
+every square, the heap search and the flow field have to give the same length.
+The old search has to reach the same squares and is never shorter. It isn't
+always shortest, though, and the number of squares it found a longer way from
+is printed.
+
+Then towers are built and sold on the grid one at a time, and after each
+change the repaired flow field is checked against a fresh search from the
+same squares. The number of squares each repair touched is printed next to the size
+of the map.
+
+Last, every 2x2 tower spot on each grid is checked for whether it would cut the
+end off from the start, once with the placement table IsLocationOccupied uses
+and once with the A* search it used before. Both have to give the same answers,
+and they are compared again at every spot a tower is built on above. The time
+to rebuild the table is printed as well.
+
+With -clusters only the hierarchical search is run: it is timed against A*
+from the start to the end, has to find a path from the same squares as A*,
+and every path it finds is walked square by square to check it. The mean
+length against A*'s shortest paths is printed, and the time to search again
+after building a tower, which rebuilds only the clusters around it.
+
+	pathbench [-reps n] [-size n] [-clusters]
+*/
+
+#include "StdHeader.h"
+#include "EngineFiles/Map.h"
+#include <stdio.h>
+
+// Node used in the old A* algorithm
+struct SearchNode
+{
+	int F,G,H;
+	int parent, loc;
+	SearchNode():F(0),G(0),H(0),parent(-1),loc(0) {}
+};
+typedef std::map<int, SearchNode> SearchNodeMap;
+
+// Width and height of the maps to test on.
+static int g_size = DEFAULT_MAP_SIZE;
+
+// Most squares to search from when searching from all of them.
+const int kMaxStarts = 400;
+
+// Steps to the squares right, up, left and down of a square.
+static const int kStepX[4] = {1, 0, -1, 0};
+static const int kStepY[4] = {0, 1, 0, -1};
+
+// Keeps the timed searches from being optimized away.
+static volatile int g_sink;
+
+// A map and the bench's own copy of its grid, zero open and anything else
+// blocked, kept in step so the searches here can read it.
+struct BenchMap
+{
+	Map						m_map;
+	std::vector<ActorId>	m_grid;
+};
+
+// A* over a grid with a binary heap open list and stamped scratch, so
+// nothing is cleared between searches. It is the search Map::TestLocation
+// ran before the flow field, kept here as the shortest path the flow field
+// and the other searches are checked against.
+class GridSearch
+{
+	CellHeap				m_openList;
+	std::vector<int>		m_G;
+	std::vector<unsigned>	m_seen;
+	std::vector<unsigned>	m_closed;
+	unsigned				m_searchId;
+
+public:
+	GridSearch():m_searchId(0) {}
+	int Run(const std::vector<ActorId> &grid, int startNode, int endNode);
+};
+
+// Searches from the start node to the end node, returns the path length or
+// -1 if there is no path.
+int GridSearch::Run(const std::vector<ActorId> &grid, int startNode, int endNode)
+{
+	int cells = grid.size();
+	if (startNode < 0 || startNode >= cells)
+		return -1;
+
+	if ((int)m_G.size() != cells)
+	{
+		m_openList.Init(cells);
+		m_G.assign(cells, 0);
+		m_seen.assign(cells, 0);
+		m_closed.assign(cells, 0);
+	}
+	m_openList.Clear();
+	m_searchId++;
+
+	// finds the temp numbers for the Manhattan distance.
+	int endX = endNode % g_size, endY = endNode / g_size;
+	m_G[startNode] = 0;
+	m_seen[startNode] = m_searchId;
+	m_openList.Push(startNode, abs(startNode % g_size - endX) + abs(startNode / g_size - endY));
+
+	// While there are nodes left to check and we are not at the end.
+	while (!m_openList.Empty())
+	{
+		// Takes the shortest distance node off the open list and closes it.
+		int cur = m_openList.Pop();
+		m_closed[cur] = m_searchId;
+		if (cur == endNode)
+			return m_G[cur];
+
+		// Checks the 4 squares around it, right, up, left and down.
+		int x = cur % g_size;
+		int y = cur / g_size;
+		for (int i = 0; i < 4; i++)
+		{
+			int tx = x + kStepX[i], ty = y + kStepY[i];
+			if (tx < 0 || tx >= g_size || ty < 0 || ty >= g_size)
+				continue;
+
+			int test = tx + ty * g_size;
+			if (grid[test] != 0 || m_closed[test] == m_searchId)
+				continue;
+
+			int G = m_G[cur] + 1;
+			if (m_seen[test] != m_searchId)
+			{
+				// First time the square is seen, add it to the open list.
+				m_seen[test] = m_searchId;
+				m_G[test] = G;
+				m_openList.Push(test, G + abs(tx - endX) + abs(ty - endY));
+			}
+			else
+			if (G < m_G[test])
+			{
+				// Found a shorter way to a square already on the open list.
+				m_G[test] = G;
+				m_openList.Decrease(test, G + abs(tx - endX) + abs(ty - endY));
+			}
+		}
+	}
+
+	return -1;
+}
+
+// Scratch for every GridSearch the bench runs.
+static GridSearch g_search;
+
+// Sets up the map and the bench's copy of the grid together.
+struct PathBench
+{
+	// Fills the grid, zero is open and anything else is blocked.
+	static void SetGrid(BenchMap &b, const std::vector<ActorId> &grid)
+	{
+		b.m_map.Init(g_size, g_size);
+		b.m_grid = grid;
+		for (int i = 0; i < g_size*g_size; i++)
+			b.m_map.SetCell(i, grid[i]);
+	}
+
+	// Gets the start square.
+	static int Start(BenchMap &b) {return b.m_map.GetStart();}
+
+	// Gets the end square.
+	static int End(BenchMap &b) {return b.m_map.GetEnd();}
+
+	// Takes or frees a square the same way building and selling towers does.
+	static void SetCell(BenchMap &b, int cell, ActorId id)
+	{
+		b.m_map.SetCell(cell, id);
+		b.m_grid[cell] = id;
+	}
+
+	// Checks the goal distances against an A* search from each square, or
+	// from an even spread of kMaxStarts squares on big maps.
+	static bool FieldMatches(BenchMap &b)
+	{
+		int step = max(1, g_size*g_size / kMaxStarts);
+		for (int i = 0; i < g_size*g_size; i += step)
+		{
+			if (b.m_grid[i] != 0)
+				continue;
+
+			Vec3 v(i % g_size - g_size/2 + 0.5f, 0, i / g_size - g_size/2 + 0.5f);
+			if (b.m_map.GetGoalDistance(v) != NewSearch(b, i))
+				return false;
+		}
+		return true;
+	}
+
+	// Runs the heap A* search, returns the path length or -1 if there is no path.
+	static int NewSearch(BenchMap &b, int start)
+	{
+		return g_search.Run(b.m_grid, start, End(b));
+	}
+
+	// The placement check IsLocationOccupied used before: takes the squares
+	// in the grid and runs A* from the start to the end. It used to let a
+	// tower cover the start square, which the new check doesn't.
+	static bool OldPlacement(BenchMap &b, int corner)
+	{
+		int cells[4] = {corner, corner + 1, corner + g_size, corner + g_size + 1};
+		for (int i = 0; i < 4; i++)
+			if (b.m_grid[cells[i]] != 0 || cells[i] == Start(b))
+				return false;
+
+		for (int i = 0; i < 4; i++)
+			b.m_grid[cells[i]] = -1;
+		bool ok = g_search.Run(b.m_grid, Start(b), End(b)) >= 0;
+		for (int i = 0; i < 4; i++)
+			b.m_grid[cells[i]] = 0;
+		return ok;
+	}
+
+	// Takes or frees a 2x2 block of squares with its lowest square at corner.
+	static void SetBlock(BenchMap &b, int corner, ActorId id)
+	{
+		SetCell(b, corner, id);
+		SetCell(b, corner + 1, id);
+		SetCell(b, corner + g_size, id);
+		SetCell(b, corner + g_size + 1, id);
+	}
+
+	// Runs the hierarchical search and walks the path it finds one cluster at a
+	// time. Returns the length, -1 if there is no path, or -2 if the path is broken.
+	static int ClusterSearch(BenchMap &b, int start)
+	{
+		std::vector<int> waypoints, cells;
+		int length = b.m_map.FindClusterPath(start, End(b), waypoints);
+		if (length < 0)
+			return -1;
+
+		int walked = 0;
+		int cur = start;
+		for (unsigned int i = 1; i < waypoints.size(); i++)
+		{
+			if (b.m_map.RefineClusterLeg(waypoints[i-1], waypoints[i], cells) < 0)
+				return -2;
+			for (unsigned int j = 0; j < cells.size(); j++)
+			{
+				int next = cells[j];
+				if (abs(next % g_size - cur % g_size) + abs(next / g_size - cur / g_size) != 1 || b.m_grid[next] != 0)
+					return -2;
+				cur = next;
+				walked++;
+			}
+		}
+
+		return (cur == End(b) && walked == length) ? length : -2;
+	}
+
+	// Takes and frees a square so the placement table is rebuilt, then checks
+	// a spot so the rebuild happens.
+	static void RebuildPlaceable(BenchMap &b)
+	{
+		ActorId id = b.m_grid[0];
+		b.m_map.SetCell(0, id ? 0 : 1);
+		b.m_map.SetCell(0, id);
+		g_sink += b.m_map.IsLocationOccupied(Vec3(0.5f, 0, 0.5f), 2, 2);
+	}
+
+	// The std::map based search Map::TestLocation used before that, returns
+	// the path length or -1. It doesn't always find the shortest path.
+	static int OldSearch(BenchMap &b, int startNode)
+	{
+		const std::vector<ActorId> &grid = b.m_grid;
+		const int MAP_SIZE = g_size;
+		int endNode = End(b);
+		bool end = false;
+		SearchNodeMap openList, closedList;
+		SearchNode cur;
+		cur.loc = startNode;
+		int endX = endNode % MAP_SIZE, endY = endNode / MAP_SIZE;
+		int dis = 9999;
+		openList[startNode] = cur;
+		SearchNodeMap::iterator it, itClosed;
+
+		while (!openList.empty() && !end)
+		{
+			dis = 9999;
+			for (it = openList.begin(); it != openList.end(); it++)
+			{
+				if ((*it).second.F <= dis)
+				{
+					cur = (*it).second;
+					dis = (*it).second.F;
+				}
+			}
+
+			if (cur.loc == endX + endY * MAP_SIZE)
+				end = true;
+
+			openList.erase(cur.loc);
+			closedList[cur.loc] = cur;
+
+			for (int i = 0; i < 4; i++)
+			{
+				int sign = (i >= 2 ? -1 : 1);
+				int test = cur.loc;
+				int x = test % MAP_SIZE;
+				int y = test / MAP_SIZE;
+
+				if (i % 2 == 0)
+				{
+					test += sign;
+					test = min(test, ((y+1)*MAP_SIZE));
+					test = max(test, (y * MAP_SIZE));
+				}
+				else
+				{
+					test += sign*MAP_SIZE;
+				}
+
+				if ((test >= 0) && (test < MAP_SIZE*MAP_SIZE) && grid[test] == 0)
+				{
+					itClosed = closedList.find(test);
+					if (itClosed == closedList.end())
+					{
+						it = openList.find(test);
+						if (it == openList.end())
+						{
+							SearchNode tmp;
+							tmp.G = cur.G + 1;
+							tmp.H = abs(x - endX) + abs(y - endY);
+							tmp.F = tmp.G + tmp.H;
+							tmp.parent = cur.loc;
+							tmp.loc = test;
+							openList[test] = tmp;
+						}
+						else
+						{
+							if ((*it).second.G > cur.G + 10)
+							{
+								(*it).second.G = cur.G + 10;
+								(*it).second.F = (*it).second.G + (*it).second.H;
+								(*it).second.parent = cur.loc;
+							}
+						}
+					}
+				}
+			}
+		}
+
+		return (end && cur.loc == endNode) ? cur.G : -1;
+	}
+};
+
+// An open map with nothing on it.
+static std::vector<ActorId> OpenGrid()
+{
+	return std::vector<ActorId>(g_size*g_size, 0);
+}
+
+// Walls every fourth column with the gap at alternating ends, so the path
+// has to snake back and forth across the whole map.
+static std::vector<ActorId> MazeGrid()
+{
+	std::vector<ActorId> grid(g_size*g_size, 0);
+	bool gapAtTop = true;
+	for (int x = 2; x < g_size - 1; x += 4)
+	{
+		for (int y = 0; y < g_size; y++)
+			grid[x + y*g_size] = 3;
+		grid[x + (gapAtTop ? g_size-1 : 0)*g_size] = 0;
+		gapAtTop = !gapAtTop;
+	}
+	return grid;
+}
+
+// Seconds from a steady clock.
+static double Now()
+{
+	timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return now.tv_sec + now.tv_nsec * 1e-9;
+}
+
+// Times both searches on one grid and prints a line for each kind of query.
+static bool RunGrid(const char *name, const std::vector<ActorId> &grid, int reps)
+{
+	BenchMap bench;
+	PathBench::SetGrid(bench, grid);
+
+	std::vector<int> starts;
+	int step = max(1, g_size*g_size / kMaxStarts);
+	for (int i = 0; i < g_size*g_size; i += step)
+		if (grid[i] == 0)
+			starts.push_back(i);
+
+	// The new search and the flow field have to give the same length from
+	// every square. The old search has to reach the same squares, and the
+	// squares it found a longer way from are counted.
+	bool agree = true;
+	int newLen = 0, oldLen = 0, reachable = 0, longer = 0;
+	for (unsigned int i = 0; i < starts.size(); i++)
+	{
+		int n = PathBench::NewSearch(bench, starts[i]);
+		int o = PathBench::OldSearch(bench, starts[i]);
+		Vec3 v(starts[i] % g_size - g_size/2 + 0.5f, 0, starts[i] / g_size - g_size/2 + 0.5f);
+		if ((n < 0) != (o < 0) || bench.m_map.GetGoalDistance(v) != n || (o >= 0 && o < n))
+			agree = false;
+		if (n >= 0 && o >= 0)
+		{
+			newLen += n;
+			oldLen += o;
+			reachable++;
+			if (o != n)
+				longer++;
+		}
+	}
+
+	double t = Now();
+	for (int r = 0; r < reps; r++)
+		g_sink += PathBench::OldSearch(bench, PathBench::Start(bench));
+	double oldSingle = (Now() - t) / reps;
+
+	t = Now();
+	for (int r = 0; r < reps; r++)
+		g_sink += PathBench::NewSearch(bench, PathBench::Start(bench));
+	double newSingle = (Now() - t) / reps;
+
+	int fieldReps = reps / 100 + 1;
+	t = Now();
+	for (int r = 0; r < fieldReps; r++)
+		for (unsigned int i = 0; i < starts.size(); i++)
+			g_sink += PathBench::OldSearch(bench, starts[i]);
+	double oldField = (Now() - t) / fieldReps;
+
+	t = Now();
+	for (int r = 0; r < fieldReps; r++)
+		for (unsigned int i = 0; i < starts.size(); i++)
+			g_sink += PathBench::NewSearch(bench, starts[i]);
+	double newField = (Now() - t) / fieldReps;
+
+	printf("%-5s start->end  old %9.2f us  new %9.2f us  speedup %6.1fx\n",
+		name, oldSingle * 1e6, newSingle * 1e6, oldSingle / newSingle);
+	printf("%-5s all %4d     old %9.2f us  new %9.2f us  speedup %6.1fx\n",
+		name, (int)starts.size(), oldField * 1e6, newField * 1e6, oldField / newField);
+	printf("%-5s reachable %d  mean length old %.2f new %.2f  old longer from %d  %s\n",
+		name, reachable, reachable ? (double)oldLen / reachable : 0.0, reachable ? (double)newLen / reachable : 0.0,
+		longer, agree ? "agree" : "DISAGREE");
+
+	return agree;
+}
+
+// Builds and sells 2x2 towers at random and prints how much of the flow field each repair touched.
+static bool RunEdits(const char *name, const std::vector<ActorId> &grid, int edits)
+{
+	BenchMap bench;
+	PathBench::SetGrid(bench, grid);
+	Map &map = bench.m_map;
+	map.UpdateFlowField();
+	int fullCount = map.GetLastRepairCount();
+
+	std::vector<int> towers;
+	ActorId nextId = 100;
+	int builds = 0, sales = 0, buildTouched = 0, saleTouched = 0, maxTouched = 0;
+	bool agree = true;
+
+	for (int e = 0; e < edits; e++)
+	{
+		// Sell one in three times once there are towers, otherwise build.
+		if (!towers.empty() && rand() % 3 == 0)
+		{
+			int at = rand() % towers.size();
+			int t = towers[at];
+			towers.erase(towers.begin() + at);
+			PathBench::SetCell(bench, t, 0);
+			PathBench::SetCell(bench, t - 1, 0);
+			PathBench::SetCell(bench, t - g_size, 0);
+			PathBench::SetCell(bench, t - g_size - 1, 0);
+			map.UpdateFlowField();
+			saleTouched += map.GetLastRepairCount();
+			sales++;
+		}
+		else
+		{
+			Vec3 loc((float)(rand() % (g_size - 1) - g_size/2), 0, (float)(rand() % (g_size - 1) - g_size/2));
+			bool allowed = map.IsLocationOccupied(loc, 2, 2);
+			if (allowed != PathBench::OldPlacement(bench, map.HashLocation(loc)))
+				agree = false;
+			if (!allowed)
+				continue;
+
+			int t = map.HashLocation(loc) + g_size + 1;
+			towers.push_back(t);
+			PathBench::SetCell(bench, t, nextId);
+			PathBench::SetCell(bench, t - 1, nextId);
+			PathBench::SetCell(bench, t - g_size, nextId);
+			PathBench::SetCell(bench, t - g_size - 1, nextId);
+			nextId++;
+			map.UpdateFlowField();
+			buildTouched += map.GetLastRepairCount();
+			builds++;
+		}
+
+		maxTouched = max(maxTouched, map.GetLastRepairCount());
+		if (!PathBench::FieldMatches(bench))
+			agree = false;
+	}
+
+	printf("%-5s field: full build %d squares, build %.1f, sell %.1f, worst %d touched (%d builds, %d sales)  %s\n",
+		name, fullCount, builds ? (double)buildTouched / builds : 0.0, sales ? (double)saleTouched / sales : 0.0,
+		maxTouched, builds, sales, agree ? "agree" : "DISAGREE");
+
+	return agree;
+}
+
+// Checks every 2x2 tower spot with both placement checks and prints the time per check.
+static bool RunPlacements(const char *name, const std::vector<ActorId> &grid, int reps)
+{
+	BenchMap bench;
+	PathBench::SetGrid(bench, grid);
+	Map &map = bench.m_map;
+
+	std::vector<Vec3> spots;
+	for (int y = 0; y < g_size - 1; y++)
+		for (int x = 0; x < g_size - 1; x++)
+			spots.push_back(Vec3(x - g_size/2 + 0.5f, 0, y - g_size/2 + 0.5f));
+
+	// Big maps only get an even spread of the spots.
+	int step = max(1, (int)spots.size() / kMaxStarts);
+	std::vector<Vec3> sample;
+	for (unsigned int i = 0; i < spots.size(); i += step)
+		sample.push_back(spots[i]);
+
+	bool agree = true;
+	int allowed = 0;
+	for (unsigned int i = 0; i < sample.size(); i++)
+	{
+		bool n = map.IsLocationOccupied(sample[i], 2, 2);
+		bool o = PathBench::OldPlacement(bench, map.HashLocation(sample[i]));
+		if (n != o)
+			agree = false;
+		if (n)
+			allowed++;
+	}
+
+	int checkReps = reps / 100 + 1;
+	double t = Now();
+	for (int r = 0; r < checkReps; r++)
+		for (unsigned int i = 0; i < sample.size(); i++)
+			g_sink += PathBench::OldPlacement(bench, map.HashLocation(sample[i]));
+	double oldCheck = (Now() - t) / (checkReps * sample.size());
+
+	t = Now();
+	for (int r = 0; r < checkReps; r++)
+		for (unsigned int i = 0; i < sample.size(); i++)
+			g_sink += map.IsLocationOccupied(sample[i], 2, 2);
+	double newCheck = (Now() - t) / (checkReps * sample.size());
+
+	t = Now();
+	for (int r = 0; r < checkReps; r++)
+		PathBench::RebuildPlaceable(bench);
+	double rebuild = (Now() - t) / checkReps;
+
+	printf("%-5s placement %d spots, %d allowed  old %9.3f us  new %9.3f us  speedup %6.1fx  rebuild %9.2f us  %s\n",
+		name, (int)sample.size(), allowed, oldCheck * 1e6, newCheck * 1e6, oldCheck / newCheck, rebuild * 1e6,
+		agree ? "agree" : "DISAGREE");
+
+	return agree;
+}
+
+// Times the hierarchical search against A* from the start to the end and checks its paths.
+static bool RunClusters(const char *name, const std::vector<ActorId> &grid, int reps)
+{
+	BenchMap bench;
+	PathBench::SetGrid(bench, grid);
+	Map &map = bench.m_map;
+	std::vector<int> waypoints;
+
+	double t = Now();
+	map.FindClusterPath(PathBench::Start(bench), PathBench::End(bench), waypoints);
+	double build = Now() - t;
+	int portals = waypoints.size();
+
+	std::vector<int> starts;
+	int step = max(1, g_size*g_size / kMaxStarts);
+	for (int i = 0; i < g_size*g_size; i += step)
+		if (grid[i] == 0)
+			starts.push_back(i);
+
+	bool agree = true;
+	double clusterLen = 0, flatLen = 0;
+	for (unsigned int i = 0; i < starts.size(); i++)
+	{
+		int c = PathBench::ClusterSearch(bench, starts[i]);
+		int f = PathBench::NewSearch(bench, starts[i]);
+		if (c == -2 || (c < 0) != (f < 0) || (c >= 0 && c < f))
+			agree = false;
+		if (c >= 0 && f >= 0)
+		{
+			clusterLen += c;
+			flatLen += f;
+		}
+	}
+
+	int queryReps = reps / 10 + 1;
+	t = Now();
+	for (int r = 0; r < queryReps; r++)
+		g_sink += PathBench::NewSearch(bench, PathBench::Start(bench));
+	double flat = (Now() - t) / queryReps;
+
+	t = Now();
+	for (int r = 0; r < queryReps; r++)
+		g_sink += map.FindClusterPath(PathBench::Start(bench), PathBench::End(bench), waypoints);
+	double cluster = (Now() - t) / queryReps;
+
+	// Builds towers at random open spots and searches again after each one.
+	int builds = 0;
+	double rebuild = 0;
+	for (int e = 0; e < 50; e++)
+	{
+		Vec3 loc((float)(rand() % (g_size - 1) - g_size/2), 0, (float)(rand() % (g_size - 1) - g_size/2));
+		if (!map.IsLocationOccupied(loc, 2, 2))
+			continue;
+
+		PathBench::SetBlock(bench, map.HashLocation(loc), 100 + e);
+		t = Now();
+		g_sink += map.FindClusterPath(PathBench::Start(bench), PathBench::End(bench), waypoints);
+		rebuild += Now() - t;
+		builds++;
+
+		if (PathBench::ClusterSearch(bench, PathBench::Start(bench)) < PathBench::NewSearch(bench, PathBench::Start(bench)))
+			agree = false;
+	}
+
+	printf("%-5s clusters start->end  A* %9.2f us  clusters %9.2f us  speedup %6.1fx  (%d waypoints)\n",
+		name, flat * 1e6, cluster * 1e6, flat / cluster, portals);
+	printf("%-5s clusters first build %.2f ms  search after a build %.2f us  length vs A* %.3f  %s\n",
+		name, build * 1e3, builds ? rebuild / builds * 1e6 : 0.0, flatLen > 0 ? clusterLen / flatLen : 0.0,
+		agree ? "agree" : "DISAGREE");
+
+	return agree;
+}
+
+int main(int argc, char *argv[])
+{
+	int reps = 2000;
+	bool clustersOnly = false;
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "-reps") == 0 && i + 1 < argc)
+			reps = atoi(argv[++i]);
+		else
+		if (strcmp(argv[i], "-size") == 0 && i + 1 < argc)
+			g_size = max(4, min(atoi(argv[++i]), MAX_MAP_SIZE));
+		else
+		if (strcmp(argv[i], "-clusters") == 0)
+			clustersOnly = true;
+		else
+		{
+			printf("usage: pathbench [-reps n] [-size n] [-clusters]\n");
+			return 1;
+		}
+	}
+	if (reps < 1)
+		reps = 1;
+
+	if (clustersOnly)
+	{
+		srand(1);
+		bool agree = RunClusters("open", OpenGrid(), reps);
+		agree = RunClusters("maze", MazeGrid(), reps) && agree;
+		return agree ? 0 : 1;
+	}
+
+	bool agree = RunGrid("open", OpenGrid(), reps);
+	agree = RunGrid("maze", MazeGrid(), reps) && agree;
+
+	srand(1);
+	agree = RunEdits("open", OpenGrid(), 200) && agree;
+	agree = RunEdits("maze", MazeGrid(), 200) && agree;
+
+	agree = RunPlacements("open", OpenGrid(), reps) && agree;
+	agree = RunPlacements("maze", MazeGrid(), reps) && agree;
+
+	return agree ? 0 : 1;
+}
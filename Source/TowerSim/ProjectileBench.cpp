@@ -0,0 +1,395 @@
+/*
+projectilebench: times ProjectileTable against flying the missiles one actor
+at a time, and shows how the hits change with the length of the updates
+against the homing MissileActor::VOnUpdate used to do.
+
+For the timing, runners walk to random squares on the map and towers fire at
+random ones. Each tick the projectiles are given where their targets are and
+where they're headed and flown, and the ones that hit or miss are fired again
+from a random tower at a random runner, the same on both sides, so the number
+in flight stays the same. Both sides have to agree to the bit on where every
+projectile is and which ones hit.
+
+Then the same shots are flown with updates of different lengths, at runners
+going in straight lines, both the old homing way and with the table. The
+table's hits should come out the same however long the updates are. The
+times to hit are to the end of the update the hit was in, and the homing
+missiles still flying are the ones that hadn't hit after twice the table's
+longest flight.
+
+	projectilebench [-projectiles n] [-runners n] [-ticks n] [-size n] [-shots n]
+*/
+
+#include "StdHeader.h"
+#include "EngineFiles/ProjectileTable.h"
+#include "EngineFiles/RunnerTable.h"
+#include <stdio.h>
+
+// How long a tick is in ms.
+const int kTickMS = 16;
+
+// How fast the missiles go, the same as TowerGame::CreateMissile.
+const int kMissileSpeed = 8;
+
+// The same as ProjectileTable's.
+const float kHitRadius = 0.1f;
+const int kMaxFlightMS = 10000;
+
+// Keeps the timed updates from being optimized away.
+static volatile int g_sink;
+
+// Seconds from a steady clock.
+static double Now()
+{
+	timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return now.tv_sec + now.tv_nsec * 1e-9;
+}
+
+// A random number from lo to hi.
+static float Random(float lo, float hi)
+{
+	return lo + (hi - lo) * (rand() / (float)RAND_MAX);
+}
+
+// The middle of a random square on the map.
+static Vec3 RandomSquare(int size)
+{
+	float half = size / 2.0f;
+	return Vec3(floor(Random(-half, half)) + 0.5f, 0, floor(Random(-half, half)) + 0.5f);
+}
+
+// A missile flown one virtual call at a time, looking its target up by id,
+// with the same sums as ProjectileTable::MoveOne.
+class BenchMissile
+{
+public:
+	Mat4x4		m_Mat;
+	Vec3		m_location, m_velocity;
+	ActorId		m_target;
+	float		m_speed;
+	int			m_elapsed;
+	int			m_action;
+
+	BenchMissile():m_target(0),m_speed((float)(kMissileSpeed * 0.003) / 10),m_elapsed(0),m_action(PA_NONE) {m_Mat = Mat4x4::g_Identity;}
+	virtual ~BenchMissile() {}
+
+	// Flies the missile for deltaMS at its target.
+	virtual void VOnUpdate(int deltaMS, const RunnerTable &runners)
+	{
+		int runner = runners.Find(m_target);
+		if (runner >= 0)
+		{
+			m_location = runners.GetLocation(runner);
+			m_velocity = runners.GetVelocity(runner);
+		}
+		else
+			m_velocity = Vec3(0, 0, 0);
+
+		float dt = (float)deltaMS;
+		Vec3 A = m_Mat.GetPosition();
+		Vec3 D = m_location - A;
+		Vec3 V = m_velocity;
+		float a = V.Dot(V) - m_speed * m_speed;
+		float b = D.Dot(V);
+		float c = D.Dot(D);
+		float t = 0;
+		if (a < 0)
+		{
+			float root = sqrt(b * b - a * c);
+			t = (b + root) / -a;
+		}
+
+		Vec3 aim = D + V * t;
+		float length = aim.Length();
+		float travel = m_speed * dt;
+		float f = 1;
+		float flying = dt;
+		if (length < travel)
+			flying = length / m_speed;
+		else
+			f = travel / length;
+		Vec3 step = aim * f;
+
+		Vec3 w = step - V * flying;
+		float ww = w.Dot(w);
+		float u = 0;
+		if (ww > 0)
+		{
+			u = D.Dot(w) / ww;
+			u = u > 0 ? u : 0;
+			u = u < 1 ? u : 1;
+		}
+		Vec3 closest = w * u - D;
+		bool hit = closest.Dot(closest) <= kHitRadius * kHitRadius;
+
+		m_Mat.SetPosition(A + step * (hit ? u : 1));
+		m_elapsed += deltaMS;
+		if (hit)
+			m_action = PA_HIT;
+		else
+		if (m_elapsed >= kMaxFlightMS)
+			m_action = PA_MISSED;
+		else
+			m_action = PA_MOVED;
+	}
+};
+
+// A missile homing on where its target is now, the way MissileActor::VOnUpdate
+// flew them.
+struct HomingMissile
+{
+	Vec3		m_loc;
+	int			m_elapsed;
+
+	// Steps the missile for deltaMS, returns true if it hit.
+	bool Update(int deltaMS, Vec3 B)
+	{
+		m_elapsed += deltaMS;
+		if (m_elapsed <= 10)
+			return false;
+
+		float k = m_loc.Distance(B);
+		if (k <= 0.1f)
+			return true;
+
+		float distanceToMove = m_elapsed / 10;
+		m_elapsed -= distanceToMove * 10;
+		float speed = kMissileSpeed * 0.003;
+		float d = (speed * distanceToMove) / k;
+		if (d > k)
+			d = k;
+
+		m_loc = m_loc + (B - m_loc) * d;
+		return false;
+	}
+};
+
+// Flies the shots with updates of tickMS both ways and prints how they did.
+// Runner r starts at from[r] and goes vel[r] in a ms, shot s is fired from
+// towers[s] at runner targets[s].
+static void CompareTicks(int tickMS, const std::vector<Vec3> &from, const std::vector<Vec3> &vel,
+	const std::vector<Vec3> &towers, const std::vector<int> &targets)
+{
+	int shots = towers.size();
+	ProjectileTable table;
+	std::vector<HomingMissile> homing(shots);
+	std::vector<int> homingHitMS(shots, -1);
+	for (int s = 0; s < shots; s++)
+	{
+		Vec3 target = from[targets[s]];
+		table.Add(s + 1, 0, targets[s] + 1, towers[s], target, kMissileSpeed);
+		homing[s].m_loc = towers[s];
+		homing[s].m_elapsed = 0;
+	}
+
+	int hits = 0, missed = 0, updates = 0, homingHits = 0;
+	double hitMS = 0, homingMS = 0;
+	std::vector<ActorId> spent;
+	for (int time = 0; time < 2 * kMaxFlightMS; time += tickMS)
+	{
+		for (int i = 0; i < table.Count(); i++)
+		{
+			int r = table.m_target[i] - 1;
+			table.SetTarget(i, from[r] + vel[r] * (float)time, vel[r]);
+		}
+		table.Move(tickMS);
+		updates += table.Count() > 0;
+
+		spent.clear();
+		for (int i = 0; i < table.Count(); i++)
+		{
+			if (table.m_action[i] == PA_HIT)
+			{
+				hits++;
+				hitMS += table.m_elapsed[i];
+			}
+			else
+			if (table.m_action[i] == PA_MISSED)
+				missed++;
+			else
+				continue;
+			spent.push_back(table.m_id[i]);
+		}
+		for (unsigned int i = 0; i < spent.size(); i++)
+			table.Remove(spent[i]);
+
+		for (int s = 0; s < shots; s++)
+		{
+			if (homingHitMS[s] >= 0)
+				continue;
+
+			int r = targets[s];
+			if (homing[s].Update(tickMS, from[r] + vel[r] * (float)(time + tickMS)))
+			{
+				homingHitMS[s] = time + tickMS;
+				homingHits++;
+				homingMS += time + tickMS;
+			}
+		}
+	}
+
+	printf("%6d ms   %6d %9.0f %7d   %6d %9.0f %7d %8d\n", tickMS,
+		homingHits, homingHits ? homingMS / homingHits : 0.0, shots - homingHits,
+		hits, hits ? hitMS / hits : 0.0, missed, updates);
+}
+
+int main(int argc, char *argv[])
+{
+	int projectiles = 20000;
+	int runners = 2000;
+	int ticks = 100;
+	int size = 64;
+	int shots = 2000;
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "-projectiles") == 0 && i + 1 < argc)
+			projectiles = max(1, atoi(argv[++i]));
+		else
+		if (strcmp(argv[i], "-runners") == 0 && i + 1 < argc)
+			runners = max(1, atoi(argv[++i]));
+		else
+		if (strcmp(argv[i], "-ticks") == 0 && i + 1 < argc)
+			ticks = max(1, atoi(argv[++i]));
+		else
+		if (strcmp(argv[i], "-size") == 0 && i + 1 < argc)
+			size = max(4, atoi(argv[++i]));
+		else
+		if (strcmp(argv[i], "-shots") == 0 && i + 1 < argc)
+			shots = max(1, atoi(argv[++i]));
+		else
+		{
+			printf("usage: projectilebench [-projectiles n] [-runners n] [-ticks n] [-size n] [-shots n]\n");
+			return 1;
+		}
+	}
+
+	srand(1);
+
+	// Runner ids are their index plus one, and nothing is removed, so their
+	// slots are their indexes.
+	RunnerTable runnerTable;
+	for (int i = 0; i < runners; i++)
+		runnerTable.Add(i + 1, RandomSquare(size), rand() % 7 + 1, 0);
+
+	std::vector<Vec3> towers(max(1, projectiles / 20), Vec3(0, 0, 0));
+	for (unsigned int i = 0; i < towers.size(); i++)
+		towers[i] = RandomSquare(size);
+
+	// Projectile ids are their missile's index plus one, so both sides can
+	// find the same one. Each missile's id keeps its own slot, the table
+	// moves them around as they hit.
+	ProjectileTable table;
+	std::vector<BenchMissile *> missiles(projectiles);
+	for (int i = 0; i < projectiles; i++)
+		missiles[i] = new BenchMissile;
+
+	std::vector<int> refire;
+	for (int i = 0; i < projectiles; i++)
+		refire.push_back(i);
+
+	double eachTime = 0, batchTime = 0;
+	int hits = 0, missed = 0;
+	bool agree = true;
+	for (int t = 0; t < ticks; t++)
+	{
+		for (int i = 0; i < runners; i++)
+		{
+			if (!runnerTable.m_hasTarget[i])
+				runnerTable.SetTarget(i, RandomSquare(size));
+		}
+		runnerTable.Move(kTickMS);
+
+		for (unsigned int r = 0; r < refire.size(); r++)
+		{
+			int i = refire[r];
+			Vec3 from = towers[rand() % towers.size()];
+			int target = rand() % runners;
+
+			BenchMissile *missile = missiles[i];
+			missile->m_Mat.SetPosition(from);
+			missile->m_location = runnerTable.GetLocation(target);
+			missile->m_target = target + 1;
+			missile->m_elapsed = 0;
+
+			table.Remove(i + 1);
+			table.Add(i + 1, 0, target + 1, from, runnerTable.GetLocation(target), kMissileSpeed);
+		}
+		refire.clear();
+
+		double start = Now();
+		for (int i = 0; i < projectiles; i++)
+			missiles[i]->VOnUpdate(kTickMS, runnerTable);
+		eachTime += Now() - start;
+
+		start = Now();
+		for (int i = 0; i < table.Count(); i++)
+		{
+			int runner = runnerTable.Find(table.m_target[i]);
+			if (runner >= 0)
+				table.SetTarget(i, runnerTable.GetLocation(runner), runnerTable.GetVelocity(runner));
+			else
+				table.StopTarget(i);
+		}
+		table.Move(kTickMS);
+		batchTime += Now() - start;
+
+		for (int i = 0; i < projectiles; i++)
+		{
+			int p = table.Find(i + 1);
+			if (p < 0)
+			{
+				agree = false;
+				continue;
+			}
+
+			Vec3 loc = missiles[i]->m_Mat.GetPosition();
+			if (loc.x != table.m_x[p] || loc.y != table.m_y[p] || loc.z != table.m_z[p] ||
+				missiles[i]->m_action != table.m_action[p])
+				agree = false;
+
+			if (table.m_action[p] == PA_HIT)
+				hits++;
+			else
+			if (table.m_action[p] == PA_MISSED)
+				missed++;
+			else
+				continue;
+			refire.push_back(i);
+			g_sink += table.m_action[p];
+		}
+	}
+
+	printf("%d projectiles, %d runners, %d ticks of %d ms, %.1f hits and %.1f misses a tick\n",
+		projectiles, runners, ticks, kTickMS, hits / (float)ticks, missed / (float)ticks);
+	printf("per missile    %9.1f us a tick\n", eachTime / ticks * 1e6);
+	printf("batched        %9.1f us a tick  speedup %6.1fx\n", batchTime / ticks * 1e6, eachTime / batchTime);
+	printf("%s\n", agree ? "agree" : "DISAGREE");
+
+	for (int i = 0; i < projectiles; i++)
+		delete missiles[i];
+
+	// Runners going straight, slower than the missiles, at two to five
+	// squares from the towers, about where a tower's range puts them.
+	std::vector<Vec3> from(shots, Vec3(0, 0, 0)), vel(shots, Vec3(0, 0, 0)), shotTowers(shots, Vec3(0, 0, 0));
+	std::vector<int> targets(shots);
+	for (int s = 0; s < shots; s++)
+	{
+		float angle = Random(0, 6.2832f);
+		float distance = Random(2, 5);
+		shotTowers[s] = RandomSquare(size);
+		from[s] = shotTowers[s] + Vec3(cos(angle) * distance, 0, sin(angle) * distance);
+		float heading = Random(0, 6.2832f);
+		float speed = (rand() % 7 + 1) * 0.0003f;
+		vel[s] = Vec3(cos(heading) * speed, 0, sin(heading) * speed);
+		targets[s] = s;
+	}
+
+	printf("\n%d shots         homing                  intercept\n", shots);
+	printf(" update      hits  mean ms  flying     hits  mean ms  missed  updates\n");
+	int tickLengths[] = {10, 16, 33, 100, 250, 500, 1000};
+	for (unsigned int i = 0; i < sizeof(tickLengths) / sizeof(tickLengths[0]); i++)
+		CompareTicks(tickLengths[i], from, vel, shotTowers, targets);
+
+	return agree ? 0 : 1;
+}
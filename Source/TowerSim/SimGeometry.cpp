@@ -0,0 +1,22 @@
+//========================================================================
+// SimGeometry.cpp : Headless versions of the geometry.cpp functions the
+// game logic needs.
+//========================================================================
+
+#include "StdHeader.h"
+
+Mat4x4 Mat4x4::g_Identity(1,0,0,0,0,1,0,0,0,0,1,0,0,0,0,1);
+
+float Vec3::Distance(const Vec3 &b)
+{
+	float k = (x - b.x) * (x - b.x) + (y - b.y) * (y - b.y) + (z - b.z) * (z - b.z);
+
+	return sqrt(k);
+}
+
+float Vec3::SqDistance(const Vec3 &b)
+{
+	float k = (x - b.x) * (x - b.x) + (y - b.y) * (y - b.y) + (z - b.z) * (z - b.z);
+
+	return k;
+}
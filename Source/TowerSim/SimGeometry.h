@@ -0,0 +1,183 @@
+#pragma once
+//========================================================================
+// SimGeometry.h : The parts of geometry.h the game logic uses, written
+// without D3DX so the simulation can be built headless.
+//
+// Matrices follow the D3DX conventions: row vectors, row major, with
+// the translation in the bottom row.
+//========================================================================
+
+class Vec4;
+
+class Vec3
+{
+public:
+	float x, y, z;
+
+	Vec3() { }
+	Vec3(const float _x, const float _y, const float _z) { x=_x; y=_y; z=_z; }
+	inline Vec3(const Vec4 &v4);
+
+	inline float Length() { return sqrt(x*x + y*y + z*z); }
+	inline Vec3 *Normalize();
+	inline float Dot(const Vec3 &b) { return x*b.x + y*b.y + z*b.z; }
+	inline Vec3 Cross(const Vec3 &b) const { return Vec3(y*b.z - z*b.y, z*b.x - x*b.z, x*b.y - y*b.x); }
+	float Distance(const Vec3 &b);
+	float SqDistance(const Vec3 &b);
+
+	Vec3 &operator += (const Vec3 &b) { x+=b.x; y+=b.y; z+=b.z; return *this; }
+	Vec3 &operator -= (const Vec3 &b) { x-=b.x; y-=b.y; z-=b.z; return *this; }
+	Vec3 &operator *= (const float f) { x*=f; y*=f; z*=f; return *this; }
+	Vec3 &operator /= (const float f) { x/=f; y/=f; z/=f; return *this; }
+
+	Vec3 operator - () const { return Vec3(-x, -y, -z); }
+	Vec3 operator + (const Vec3 &b) const { return Vec3(x+b.x, y+b.y, z+b.z); }
+	Vec3 operator - (const Vec3 &b) const { return Vec3(x-b.x, y-b.y, z-b.z); }
+	Vec3 operator * (const float f) const { return Vec3(x*f, y*f, z*f); }
+	Vec3 operator / (const float f) const { return Vec3(x/f, y/f, z/f); }
+
+	bool operator == (const Vec3 &b) const { return x==b.x && y==b.y && z==b.z; }
+	bool operator != (const Vec3 &b) const { return !(*this == b); }
+};
+
+inline Vec3 *Vec3::Normalize()
+{
+	float len = Length();
+	if (len > 0.0f)
+		*this /= len;
+	return this;
+}
+
+class Vec4
+{
+public:
+	float x, y, z, w;
+
+	Vec4() { }
+	Vec4(const float _x, const float _y, const float _z, const float _w) { x=_x; y=_y; z=_z; w=_w; }
+	Vec4(const Vec3 &v3) { x = v3.x; y = v3.y; z = v3.z; w = 1.0f; }
+
+	inline float Length() { return sqrt(x*x + y*y + z*z + w*w); }
+	inline float Dot(const Vec4 &b) { return x*b.x + y*b.y + z*b.z + w*b.w; }
+
+	Vec4 &operator *= (const float f) { x*=f; y*=f; z*=f; w*=f; return *this; }
+	Vec4 operator + (const Vec4 &b) const { return Vec4(x+b.x, y+b.y, z+b.z, w+b.w); }
+	Vec4 operator - (const Vec4 &b) const { return Vec4(x-b.x, y-b.y, z-b.z, w-b.w); }
+	Vec4 operator * (const float f) const { return Vec4(x*f, y*f, z*f, w*f); }
+};
+
+inline Vec3::Vec3(const Vec4 &v4) { x = v4.x; y = v4.y; z = v4.z; }
+
+typedef std::list<Vec3> Vec3List;
+typedef std::list<Vec4> Vec4List;
+
+class Mat4x4
+{
+public:
+	float m[4][4];
+
+	Mat4x4() { }
+	Mat4x4(float _11, float _12, float _13, float _14,
+		   float _21, float _22, float _23, float _24,
+		   float _31, float _32, float _33, float _34,
+		   float _41, float _42, float _43, float _44)
+	{
+		m[0][0]=_11; m[0][1]=_12; m[0][2]=_13; m[0][3]=_14;
+		m[1][0]=_21; m[1][1]=_22; m[1][2]=_23; m[1][3]=_24;
+		m[2][0]=_31; m[2][1]=_32; m[2][2]=_33; m[2][3]=_34;
+		m[3][0]=_41; m[3][1]=_42; m[3][2]=_43; m[3][3]=_44;
+	}
+
+	static Mat4x4 g_Identity;
+
+	// Modifiers
+	inline void SetPosition(Vec3 const &pos);
+	inline void SetPosition(Vec4 const &pos);
+
+	// Accessors and Calculation Methods
+	inline Vec3 GetPosition() const;
+	inline Vec4 Xform(Vec4 &v) const;
+	inline Vec3 Xform(Vec3 &v) const;
+
+	// Initialization methods
+	inline void BuildTranslation(const Vec3 &pos);
+	inline void BuildTranslation(const float x, const float y, const float z );
+	inline void BuildRotationY(const float radians);
+};
+
+inline void Mat4x4::SetPosition(Vec3 const &pos)
+{
+	m[3][0] = pos.x;
+	m[3][1] = pos.y;
+	m[3][2] = pos.z;
+	m[3][3] = 1.0f;
+}
+
+inline void Mat4x4::SetPosition(Vec4 const &pos)
+{
+	m[3][0] = pos.x;
+	m[3][1] = pos.y;
+	m[3][2] = pos.z;
+	m[3][3] = pos.w;
+}
+
+inline Vec3 Mat4x4::GetPosition() const
+{
+	return Vec3(m[3][0], m[3][1], m[3][2]);
+}
+
+inline Vec4 Mat4x4::Xform(Vec4 &v) const
+{
+	return Vec4(v.x*m[0][0] + v.y*m[1][0] + v.z*m[2][0] + v.w*m[3][0],
+				v.x*m[0][1] + v.y*m[1][1] + v.z*m[2][1] + v.w*m[3][1],
+				v.x*m[0][2] + v.y*m[1][2] + v.z*m[2][2] + v.w*m[3][2],
+				v.x*m[0][3] + v.y*m[1][3] + v.z*m[2][3] + v.w*m[3][3]);
+}
+
+inline Vec3 Mat4x4::Xform(Vec3 &v) const
+{
+	Vec4 temp(v);
+	return Vec3(Xform(temp));
+}
+
+inline void Mat4x4::BuildTranslation(const Vec3 &pos)
+{
+	BuildTranslation(pos.x, pos.y, pos.z);
+}
+
+inline void Mat4x4::BuildTranslation(const float x, const float y, const float z )
+{
+	*this = Mat4x4::g_Identity;
+	m[3][0] = x;
+	m[3][1] = y;
+	m[3][2] = z;
+}
+
+// Same layout as D3DXMatrixRotationY.
+inline void Mat4x4::BuildRotationY(const float radians)
+{
+	float c = cos(radians), s = sin(radians);
+	*this = Mat4x4::g_Identity;
+	m[0][0] = c;
+	m[0][2] = -s;
+	m[2][0] = s;
+	m[2][2] = c;
+}
+
+inline Mat4x4 operator * (const Mat4x4 &a, const Mat4x4 &b)
+{
+	Mat4x4 out;
+	for (int i = 0; i < 4; i++)
+		for (int j = 0; j < 4; j++)
+			out.m[i][j] = a.m[i][0]*b.m[0][j] + a.m[i][1]*b.m[1][j] + a.m[i][2]*b.m[2][j] + a.m[i][3]*b.m[3][j];
+	return out;
+}
+
+// Stands in for D3DXCOLOR.
+struct Color
+{
+	float r, g, b, a;
+
+	Color() { }
+	Color(const float _r, const float _g, const float _b, const float _a) { r=_r; g=_g; b=_b; a=_a; }
+};
@@ -0,0 +1,164 @@
+/*
+towersim: runs the game logic without a window, a device or any views.
+
+Loads the lua scripts from a directory, places any towers given on the
+command line, then steps the game at a fixed rate until it is lost or one
+of the limits is hit. Prints a one line summary at the end so runs can be
+compared against each other.
+
+	towersim [-data dir] [-seed n] [-step ms] [-ticks n] [-waves n] [-tower type x z]...
+*/
+
+#include "StdHeader.h"
+#include "Event.h"
+#include "EngineFiles/GameLogic.h"
+#include "ResourceCache/ResCache2.h"
+#include <stdio.h>
+
+// A tower to place before the first wave.
+struct SimTower
+{
+	int		m_type;
+	Vec3	m_loc;
+};
+typedef std::vector<SimTower> SimTowerList;
+
+// Time the event queue gets each tick. Long enough that it always empties.
+const unsigned int kEventTimeMS = 60000;
+
+// Settings for a run, filled in from the command line.
+struct SimOptions
+{
+	std::string		m_dataDir;
+	unsigned int	m_seed;
+	int				m_stepMS;
+	int				m_maxTicks;
+	int				m_maxWaves;
+	SimTowerList	m_towers;
+
+	SimOptions():m_dataDir("."),m_seed(1),m_stepMS(16),m_maxTicks(60000),m_maxWaves(0) {}
+};
+
+// Prints how to use the program.
+static void PrintUsage()
+{
+	printf("usage: towersim [-data dir] [-seed n] [-step ms] [-ticks n] [-waves n] [-tower type x z]...\n");
+}
+
+// Reads the command line into the options, returns false if it can't.
+static bool ParseArgs(int argc, char *argv[], SimOptions &o)
+{
+	for (int i = 1; i < argc; i++)
+	{
+		std::string arg = argv[i];
+		bool hasValue = i + 1 < argc;
+
+		if (arg == "-data" && hasValue)
+			o.m_dataDir = argv[++i];
+		else
+		if (arg == "-seed" && hasValue)
+			o.m_seed = (unsigned int)strtoul(argv[++i], NULL, 10);
+		else
+		if (arg == "-step" && hasValue)
+			o.m_stepMS = atoi(argv[++i]);
+		else
+		if (arg == "-ticks" && hasValue)
+			o.m_maxTicks = atoi(argv[++i]);
+		else
+		if (arg == "-waves" && hasValue)
+			o.m_maxWaves = atoi(argv[++i]);
+		else
+		if (arg == "-tower" && i + 3 < argc)
+		{
+			SimTower t;
+			t.m_type = atoi(argv[++i]);
+			t.m_loc.x = (float)atof(argv[++i]);
+			t.m_loc.y = 0;
+			t.m_loc.z = (float)atof(argv[++i]);
+			o.m_towers.push_back(t);
+		}
+		else
+			return false;
+	}
+
+	return o.m_stepMS > 0;
+}
+
+// Turns the game status into something printable.
+static const char *StatusName(GameStatus status)
+{
+	switch (status)
+	{
+		case Game_Initializing:	return "initializing";
+		case Game_Running:		return "running";
+		case Game_Pause:		return "paused";
+		case Game_Over:			return "over";
+		default:				return "unknown";
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	SimOptions options;
+	if (!ParseArgs(argc, argv, options))
+	{
+		PrintUsage();
+		return 1;
+	}
+
+	srand(options.m_seed);
+
+	// The event manager has to exist before anything adds a listener.
+	EventManager eventManager;
+
+	ResCache cache(5, SAFE_NEW ResourceDirectory(options.m_dataDir));
+	Resource mainScript("test.lua");
+	if (!cache.Init() || cache.Create(mainScript) <= 0)
+	{
+		fprintf(stderr, "towersim: can't read %s/test.lua\n", options.m_dataDir.c_str());
+		return 1;
+	}
+
+	TowerGame game(&cache);
+
+	// The first update builds the scene and reads the tower types.
+	game.OnUpdate(0);
+	safeTick(kEventTimeMS);
+	if (game.GetStatus() != Game_Running)
+	{
+		fprintf(stderr, "towersim: the game failed to start\n");
+		return 1;
+	}
+
+	int placed = 0;
+	for (SimTowerList::iterator it = options.m_towers.begin(); it != options.m_towers.end(); it++)
+	{
+		int before = game.GetData().m_curMoney;
+		game.ChangeTowerType((*it).m_type);
+		game.CreateTower((*it).m_loc);
+		if (game.GetData().m_curMoney != before)
+			placed++;
+	}
+	game.ChangeTowerType(-1);
+	safeTick(kEventTimeMS);
+
+	DWORD startTime = GetTickCount();
+	int ticks = 0;
+	while (ticks < options.m_maxTicks && game.GetStatus() == Game_Running)
+	{
+		if (options.m_maxWaves > 0 && game.GetData().m_curWave > options.m_maxWaves)
+			break;
+
+		safeTick(kEventTimeMS);
+		game.OnUpdate(options.m_stepMS);
+		ticks++;
+	}
+	DWORD wallMS = GetTickCount() - startTime;
+
+	GameData data = game.GetData();
+	printf("ticks=%d towers=%d/%d wave=%d life=%d money=%d status=%s wall_ms=%u ticks_per_sec=%.0f\n",
+		ticks, placed, (int)options.m_towers.size(), data.m_curWave, data.m_curLife, data.m_curMoney,
+		StatusName(game.GetStatus()), wallMS, wallMS ? ticks * 1000.0 / wallMS : 0.0);
+
+	return 0;
+}
@@ -0,0 +1,58 @@
+#pragma once
+//========================================================================
+// SimPlatform.h : Stand-ins for the Windows types and calls the game
+// logic uses, so it can be built without Windows, DXUT or Direct3D.
+//
+// Only included by StdHeader.h when TOWERSIM_HEADLESS is defined.
+//========================================================================
+
+#include <assert.h>
+#include <math.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <string>
+#include <list>
+#include <queue>
+#include <map>
+#include <vector>
+#include <algorithm>
+
+typedef unsigned int	DWORD;
+typedef unsigned char	BYTE;
+typedef unsigned int	UINT;
+typedef int				HRESULT;
+typedef ptrdiff_t		LRESULT;
+typedef size_t			WPARAM;
+typedef ptrdiff_t		LPARAM;
+typedef void *			HWND;
+typedef wchar_t			_TCHAR;
+typedef wchar_t			TCHAR;
+
+#define _T(x)			L##x
+#define CALLBACK
+#define TRUE			1
+#define FALSE			0
+#define S_OK			((HRESULT)0)
+#define S_FALSE			((HRESULT)1)
+#define SUCCEEDED(hr)	(((HRESULT)(hr)) >= 0)
+#define FAILED(hr)		(((HRESULT)(hr)) < 0)
+
+#define SAFE_NEW new
+
+// The Windows headers give these as macros.
+using std::min;
+using std::max;
+
+// Only ever passed around by pointer or reference in the game logic.
+struct IDirect3DDevice9;
+class CDXUTTextHelper;
+
+// Milliseconds from a steady clock, stands in for the Windows tick count.
+inline DWORD GetTickCount()
+{
+	timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (DWORD)(now.tv_sec * 1000 + now.tv_nsec / 1000000);
+}
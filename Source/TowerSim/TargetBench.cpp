@@ -0,0 +1,213 @@
+/*
+targetbench: times finding every tower's target in one pass against finding
+them one tower at a time.
+
+Runners are scattered over the map and a little way off it, and towers are
+put on random squares with ranges from 2 to 7. Each tick the runners move
+and then every tower looks for the closest runner in range three ways: by
+checking every runner, with Map::FindClosestRunner per tower, and with one
+Map::FindClosestRunners call for all of them. All three have to pick the
+same runner for every tower.
+
+Then Map::FindTargets is timed with every tower using each of the other
+targeting policies, next to Map::FindBestRunner per tower, and both are
+checked against ranking every runner by how far it has left to go or its
+life. FindTargets only packs the runners when it expects that to be
+faster, so on big sparse maps the two take the same path.
+
+	targetbench [-towers n] [-runners n] [-ticks n] [-size n]
+*/
+
+#include "StdHeader.h"
+#include "EngineFiles/Map.h"
+#include <stdio.h>
+
+// Keeps the timed searches from being optimized away.
+static volatile int g_sink;
+
+// Seconds from a steady clock.
+static double Now()
+{
+	timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return now.tv_sec + now.tv_nsec * 1e-9;
+}
+
+// A random number from lo to hi.
+static float Random(float lo, float hi)
+{
+	return lo + (hi - lo) * (rand() / (float)RAND_MAX);
+}
+
+// Scores a runner the way a targeting policy ranks them, lowest first.
+static float PolicyKey(int policy, float progress, float life)
+{
+	const float behind = (float)0x3fffffff;
+	if (policy == TP_FIRST)
+		return progress >= 0 ? progress : behind;
+	if (policy == TP_LAST)
+		return progress >= 0 ? -progress : behind;
+	return -life;
+}
+
+// Picks the runner in range a policy ranks best by checking every one. Ties go to the lowest id.
+static ActorId BestOfAll(const std::vector<Vec3> &runners, const std::vector<float> &progress, const std::vector<float> &life,
+						 int policy, Vec3 v, float range)
+{
+	ActorId best = 0;
+	float bestKey = 0;
+	for (unsigned int i = 0; i < runners.size(); i++)
+	{
+		float dx = runners[i].x - v.x;
+		float dz = runners[i].z - v.z;
+		if (dx * dx + dz * dz > range * range)
+			continue;
+
+		float key = PolicyKey(policy, progress[i], life[i]);
+		if (best == 0 || key < bestKey)
+		{
+			best = i + 1;
+			bestKey = key;
+		}
+	}
+	return best;
+}
+
+// Finds the closest runner in range by checking every one. Ties go to the lowest id.
+static ActorId ClosestOfAll(const std::vector<Vec3> &runners, Vec3 v, float range)
+{
+	ActorId best = 0;
+	float bestSq = range * range;
+	for (unsigned int i = 0; i < runners.size(); i++)
+	{
+		float dx = runners[i].x - v.x;
+		float dz = runners[i].z - v.z;
+		float sq = dx * dx + dz * dz;
+		if (sq < bestSq || (sq == bestSq && best == 0))
+		{
+			best = i + 1;
+			bestSq = sq;
+		}
+	}
+	return best;
+}
+
+int main(int argc, char *argv[])
+{
+	int towers = 1000;
+	int runners = 20000;
+	int ticks = 20;
+	int size = DEFAULT_MAP_SIZE;
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "-towers") == 0 && i + 1 < argc)
+			towers = max(1, atoi(argv[++i]));
+		else
+		if (strcmp(argv[i], "-runners") == 0 && i + 1 < argc)
+			runners = max(1, atoi(argv[++i]));
+		else
+		if (strcmp(argv[i], "-ticks") == 0 && i + 1 < argc)
+			ticks = max(1, atoi(argv[++i]));
+		else
+		if (strcmp(argv[i], "-size") == 0 && i + 1 < argc)
+			size = max(4, min(atoi(argv[++i]), MAX_MAP_SIZE));
+		else
+		{
+			printf("usage: targetbench [-towers n] [-runners n] [-ticks n] [-size n]\n");
+			return 1;
+		}
+	}
+
+	srand(1);
+	Map map(size, size);
+	float half = size / 2.0f;
+
+	// Runner ids are their index plus one, so the brute force can use them.
+	std::vector<Vec3> runnerLocs(runners, Vec3(0, 0, 0));
+	std::vector<float> life(runners);
+	std::vector<float> progress(runners);
+	for (int i = 0; i < runners; i++)
+	{
+		runnerLocs[i] = Vec3(Random(-half - 1, half + 1), 0, Random(-half - 1, half + 1));
+		life[i] = (float)(rand() % 10 + 1);
+		map.AddRunner(i + 1, runnerLocs[i], life[i]);
+	}
+
+	std::vector<Vec3> towerLocs(towers, Vec3(0, 0, 0));
+	std::vector<float> ranges(towers);
+	for (int i = 0; i < towers; i++)
+	{
+		towerLocs[i] = Vec3(floor(Random(-half, half)) + 0.5f, 0, floor(Random(-half, half)) + 0.5f);
+		ranges[i] = Random(2, 7);
+	}
+
+	double allTime = 0, eachTime = 0, batchTime = 0;
+	double policyTime[TP_COUNT] = {0}, policyEachTime[TP_COUNT] = {0};
+	std::vector<ActorId> all(towers), each(towers), batch;
+	std::vector<int> policies(towers);
+	bool agree = true;
+	for (int t = 0; t < ticks; t++)
+	{
+		for (int i = 0; i < runners; i++)
+		{
+			runnerLocs[i].x += Random(-0.1f, 0.1f);
+			runnerLocs[i].z += Random(-0.1f, 0.1f);
+			map.MoveActor(i + 1, runnerLocs[i]);
+		}
+
+		double start = Now();
+		for (int i = 0; i < towers; i++)
+			all[i] = ClosestOfAll(runnerLocs, towerLocs[i], ranges[i]);
+		allTime += Now() - start;
+
+		start = Now();
+		for (int i = 0; i < towers; i++)
+			each[i] = map.FindClosestRunner(towerLocs[i], ranges[i]);
+		eachTime += Now() - start;
+
+		start = Now();
+		map.FindClosestRunners(towerLocs, ranges, batch);
+		batchTime += Now() - start;
+
+		for (int i = 0; i < towers; i++)
+		{
+			g_sink += batch[i];
+			if (all[i] != each[i] || all[i] != batch[i])
+				agree = false;
+		}
+
+		for (int i = 0; i < runners; i++)
+			progress[i] = map.GetPathProgress(runnerLocs[i]);
+
+		for (int p = TP_FIRST; p < TP_COUNT; p++)
+		{
+			std::fill(policies.begin(), policies.end(), p);
+			start = Now();
+			map.FindTargets(towerLocs, ranges, policies, batch);
+			policyTime[p] += Now() - start;
+
+			start = Now();
+			for (int i = 0; i < towers; i++)
+				each[i] = map.FindBestRunner(towerLocs[i], ranges[i], p);
+			policyEachTime[p] += Now() - start;
+
+			for (int i = 0; i < towers; i++)
+			{
+				ActorId expect = BestOfAll(runnerLocs, progress, life, p, towerLocs[i], ranges[i]);
+				if (batch[i] != expect || each[i] != expect)
+					agree = false;
+			}
+		}
+	}
+
+	printf("%d towers, %d runners, %dx%d map, %d ticks\n", towers, runners, size, size, ticks);
+	printf("every runner   %9.1f us a tick\n", allTime / ticks * 1e6);
+	printf("per tower      %9.1f us a tick  speedup %6.1fx\n", eachTime / ticks * 1e6, allTime / eachTime);
+	printf("batched        %9.1f us a tick  speedup %6.1fx\n", batchTime / ticks * 1e6, allTime / batchTime);
+	printf("first          %9.1f us a tick  per tower %9.1f us\n", policyTime[TP_FIRST] / ticks * 1e6, policyEachTime[TP_FIRST] / ticks * 1e6);
+	printf("last           %9.1f us a tick  per tower %9.1f us\n", policyTime[TP_LAST] / ticks * 1e6, policyEachTime[TP_LAST] / ticks * 1e6);
+	printf("strongest      %9.1f us a tick  per tower %9.1f us\n", policyTime[TP_STRONGEST] / ticks * 1e6, policyEachTime[TP_STRONGEST] / ticks * 1e6);
+	printf("%s\n", agree ? "agree" : "DISAGREE");
+
+	return agree ? 0 : 1;
+}
@@ -1,4 +1,5 @@
 map = { ["color"] = white,
-		["texture"] = "skeleton.bmp"
-
+		["texture"] = "skeleton.bmp",
+		["width"] = 20,
+		["height"] = 20
 }
@@ -3,6 +3,7 @@ id = 0
 damage = 1
 reload = 1000
 range = 2
+targeting = "closest"
 cost = 1
 shottexture = "red.bmp"
 chartexture = "tower1.dds"
@@ -6,6 +6,7 @@ lastShot = 0
 damage = 3
 reload = 2000
 range = 2
+targeting = "closest"
 cost = 3
 shottexture = "ice.dds"
 chartexture = "tower2.dds"
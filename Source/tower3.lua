@@ -3,6 +3,7 @@ id = 0
 damage = 1
 reload = 1000
 range = 2
+targeting = "closest"
 cost = 2
 shottexture = "ice.dds"
 chartexture = "tower3.dds"
@@ -3,9 +3,10 @@ id = 0
 damage = 1
 reload = 1000
 range = 5
+targeting = "closest"
 cost = 1
 shottexture = "clear.dds"
-target = -1
+target = no_target
 chartexture = "tower4.dds"
 
 function OnUpdate (deltaMS)